@@ -1,5 +1,6 @@
 #include "APU.hpp"
 #include "GB.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <array>
 
@@ -40,12 +41,112 @@ int8_t calculateChannel4Sample(const GameBoyAPU* apu) noexcept {
     return (apu->CH4.lfsr & 1) ? apu->CH4.volume : 0;
 }
 
-inline void updateCounter(uint16_t& counter, uint16_t wavelen, uint8_t& index) noexcept {
+bool isAPUEnabled(const GameBoyAPU* apu) noexcept {
+    return (apu->GB->io[NR52] & static_cast<uint8_t>(APUConstants::NR52::APU_ENABLE_BIT)) != 0;
+}
+
+int calculateNoiseRate(const GameBoyAPU* apu) noexcept {
+    int rate = 2 << ((apu->GB->io[NR43] & static_cast<uint8_t>(APUConstants::NR43::CLOCK_SHIFT_MASK)) >> 4);
+    if (apu->GB->io[NR43] & static_cast<uint8_t>(APUConstants::NR43::DIVISOR_MASK)) {
+        rate *= (apu->GB->io[NR43] & static_cast<uint8_t>(APUConstants::NR43::DIVISOR_MASK));
+    }
+    return rate;
+}
+
+bool isNoiseNarrow(const GameBoyAPU* apu) noexcept {
+    return (apu->GB->io[NR43] & static_cast<uint8_t>(APUConstants::NR43::WIDTH_MODE_BIT)) != 0;
+}
+
+uint16_t stepNoiseLFSR(uint16_t lfsr, bool narrow) noexcept {
+    uint16_t bit = (~(lfsr ^ (lfsr >> 1))) & 1;
+    lfsr = (lfsr & ~(1 << 15)) | (bit << 15);
+    if (narrow) {
+        lfsr = (lfsr & ~(1 << 7)) | (bit << 7);
+    }
+    return static_cast<uint16_t>(lfsr >> 1);
+}
+
+struct NoiseLFSRJump {
+    std::array<uint16_t, 16> columns;
+    uint16_t constant;
+};
+
+uint16_t applyNoiseLFSRJump(const NoiseLFSRJump& jump, uint16_t lfsr) noexcept {
+    uint16_t result = jump.constant;
+    for (int bit = 0; bit < 16; bit++) {
+        if (lfsr & (1 << bit)) result ^= jump.columns[bit];
+    }
+    return result;
+}
+
+using NoiseLFSRJumpTable = std::array<std::array<NoiseLFSRJump, APUConstants::LFSR_JUMP_LEVELS>, 2>;
+
+static const NoiseLFSRJumpTable& noiseLFSRJumps() {
+    static const NoiseLFSRJumpTable table = []() {
+        NoiseLFSRJumpTable jumps{};
+        for (int narrow = 0; narrow < 2; narrow++) {
+            NoiseLFSRJump& single = jumps[narrow][0];
+            single.constant = stepNoiseLFSR(0, narrow != 0);
+            for (int bit = 0; bit < 16; bit++) {
+                single.columns[bit] = stepNoiseLFSR(static_cast<uint16_t>(1 << bit), narrow != 0) ^ single.constant;
+            }
+            for (int level = 1; level < APUConstants::LFSR_JUMP_LEVELS; level++) {
+                const NoiseLFSRJump& half = jumps[narrow][level - 1];
+                NoiseLFSRJump& doubled = jumps[narrow][level];
+                doubled.constant = applyNoiseLFSRJump(half, half.constant);
+                for (int bit = 0; bit < 16; bit++) {
+                    doubled.columns[bit] = applyNoiseLFSRJump(half, half.columns[bit]) ^ half.constant;
+                }
+            }
+        }
+        return jumps;
+        }();
+    return table;
+}
+
+uint16_t jumpNoiseLFSR(uint16_t lfsr, uint32_t steps, bool narrow) noexcept {
+    const std::array<NoiseLFSRJump, APUConstants::LFSR_JUMP_LEVELS>& jumps = noiseLFSRJumps()[narrow ? 1 : 0];
+    for (int level = 0; steps != 0; level++, steps >>= 1) {
+        if (steps & 1) lfsr = applyNoiseLFSRJump(jumps[level], lfsr);
+    }
+    return lfsr;
+}
+
+inline bool updateCounter(uint16_t& counter, uint16_t wavelen, uint8_t& index) noexcept {
     counter++;
     if (counter >= 2048) {
         counter = wavelen;
         index++;
+        return true;
+    }
+    return false;
+}
+
+inline uint32_t ticksUntilOverflow(int counter, int limit) noexcept {
+    return counter >= limit - 1 ? 1 : static_cast<uint32_t>(limit - counter);
+}
+
+inline void advanceCounter(uint16_t& counter, uint16_t wavelen, uint8_t& index, uint32_t ticks) noexcept {
+    uint32_t untilOverflow = ticksUntilOverflow(counter, 2048);
+    if (ticks < untilOverflow) {
+        counter = static_cast<uint16_t>(counter + ticks);
+        return;
     }
+    ticks -= untilOverflow;
+    uint32_t period = ticksUntilOverflow(wavelen, 2048);
+    counter = static_cast<uint16_t>(wavelen + ticks % period);
+    index = static_cast<uint8_t>(index + 1 + ticks / period);
+}
+
+inline uint32_t advanceNoiseCounter(int& counter, int rate, uint32_t ticks) noexcept {
+    uint32_t untilOverflow = ticksUntilOverflow(counter, rate);
+    if (ticks < untilOverflow) {
+        counter += static_cast<int>(ticks);
+        return 0;
+    }
+    ticks -= untilOverflow;
+    counter = static_cast<int>(ticks % rate);
+    return 1 + ticks / rate;
 }
 
 inline void updateEnvelope(uint8_t& env_counter, uint8_t env_pace, bool env_dir, uint8_t& volume) noexcept {
@@ -63,88 +164,133 @@ inline void updateEnvelope(uint8_t& env_counter, uint8_t env_pace, bool env_dir,
     }
 }
 
-void APUClock(GameBoyAPU* apu) {
-    if (!(apu->GB->io[NR52] & static_cast<uint8_t>(APUConstants::NR52::APU_ENABLE_BIT))) {
-        apu->GB->io[NR52] = 0;
-        apu->apuDivider = 0;
-        apu->audioSampleIndex = 0;
-        return;
-    }
-
+void updateChannelStatus(GameBoyAPU* apu) noexcept {
     apu->GB->io[NR52] = static_cast<uint8_t>(APUConstants::NR52::APU_ENABLE_BIT) |
         (apu->CH1.enable ? 0x01 : 0) |
         (apu->CH2.enable ? 0x02 : 0) |
         (apu->CH3.enable ? 0x04 : 0) |
         (apu->CH4.enable ? 0x08 : 0);
+}
+
+void setAPUOutput(GameBoyAPU* apu, float left, float right) {
+    if (left != apu->leftLevel) {
+        addBlipDelta(&apu->leftBlip, apu->blipTime, left - apu->leftLevel);
+        apu->leftLevel = left;
+    }
+    if (right != apu->rightLevel) {
+        addBlipDelta(&apu->rightBlip, apu->blipTime, right - apu->rightLevel);
+        apu->rightLevel = right;
+    }
+}
+
+void updateAPUOutput(GameBoyAPU* apu) {
+    int8_t ch1_sample = apu->CH1.enable ? calculateChannel1Sample(apu) : 0;
+    int8_t ch2_sample = apu->CH2.enable ? calculateChannel2Sample(apu) : 0;
+    int8_t ch3_sample = apu->CH3.enable ? calculateChannel3Sample(apu) : 0;
+    int8_t ch4_sample = apu->CH4.enable ? calculateChannel4Sample(apu) : 0;
+
+    uint8_t l_sample = 0, r_sample = 0;
+
+    uint8_t nr51 = apu->GB->io[NR51];
+    if (nr51 & 0x01) r_sample += ch1_sample;
+    if (nr51 & 0x02) r_sample += ch2_sample;
+    if (nr51 & 0x04) r_sample += ch3_sample;
+    if (nr51 & 0x08) r_sample += ch4_sample;
+    if (nr51 & 0x10) l_sample += ch1_sample;
+    if (nr51 & 0x20) l_sample += ch2_sample;
+    if (nr51 & 0x40) l_sample += ch3_sample;
+    if (nr51 & 0x80) l_sample += ch4_sample;
+
+    uint8_t nr50 = apu->GB->io[NR50];
+    float left_volume = (static_cast<float>(l_sample) / 500.0f) *
+        (static_cast<float>(((nr50 & static_cast<uint8_t>(APUConstants::NR50::LEFT_VOLUME_MASK)) >> 4) + 1));
+    float right_volume = (static_cast<float>(r_sample) / 500.0f) *
+        (static_cast<float>((nr50 & static_cast<uint8_t>(APUConstants::NR50::RIGHT_VOLUME_MASK)) + 1));
+
+    setAPUOutput(apu, left_volume, right_volume);
+}
+
+void advanceAPUTime(GameBoyAPU* apu) {
+    if (++apu->blipTime < APUConstants::BLIP_FRAME_CYCLES) return;
+
+    endBlipFrame(&apu->leftBlip, apu->blipTime);
+    endBlipFrame(&apu->rightBlip, apu->blipTime);
+    apu->blipTime = 0;
+
+    constexpr int frames = APUConstants::SAMPLE_BUF_LEN / 2;
+    if (apu->isAudioBufferFull) return;
+    int needed = resamplerInputNeeded(&apu->resampler, frames);
+    if (blipSamplesAvailable(&apu->leftBlip) >= needed) {
+        Resampler* resampler = &apu->resampler;
+        readBlipSamples(&apu->leftBlip, resampler->left.data() + resampler->buffered, needed, 1);
+        readBlipSamples(&apu->rightBlip, resampler->right.data() + resampler->buffered, needed, 1);
+        resampleFrames(resampler, needed, apu->audioSampleBuffer.data(), frames);
+        apu->isAudioBufferFull = true;
+    }
+}
+
+void resetAPU(GameBoyAPU* apu) {
+    apu->audioEnabled = true;
+    for (BlipBuffer* blip : { &apu->leftBlip, &apu->rightBlip }) {
+        clearBlipBuffer(blip);
+        setBlipRates(blip, APUConstants::BASE_FREQUENCY, APUConstants::INTERNAL_SAMPLE_FREQ);
+    }
+    setAPUOutputFrequency(apu, APUConstants::SAMPLE_FREQ);
+    apu->blipTime = 0;
+    apu->leftLevel = 0.0f;
+    apu->rightLevel = 0.0f;
+    apu->outputDirty = true;
+    apu->pendingCycles = 0;
+    apu->cyclesUntilEvent = 1;
+    apu->elapsedCycles = 0;
+}
+
+void setAPUOutputFrequency(GameBoyAPU* apu, int frequency) {
+    apu->outputFrequency = frequency;
+    initResampler(&apu->resampler, APUConstants::INTERNAL_SAMPLE_FREQ, frequency);
+    apu->isAudioBufferFull = false;
+}
+
+void stepAPU(GameBoyAPU* apu, uint32_t div) {
+    if (!(apu->GB->io[NR52] & static_cast<uint8_t>(APUConstants::NR52::APU_ENABLE_BIT))) {
+        apu->GB->io[NR52] = 0;
+        apu->apuDivider = 0;
+        if (apu->audioEnabled) {
+            setAPUOutput(apu, 0.0f, 0.0f);
+            advanceAPUTime(apu);
+        }
+        return;
+    }
 
-    uint32_t div = apu->GB->div;
+    updateChannelStatus(apu);
 
     if (div % 2 == 0) {
         apu->CH3.counter++;
         if (apu->CH3.counter >= 2048) {
             apu->CH3.counter = apu->CH3.wavelen;
             apu->CH3.audioSampleIndexex++;
+            apu->outputDirty = true;
         }
     }
 
     if (div % 4 == 0) {
-        updateCounter(apu->CH1.counter, apu->CH1.wavelen, apu->CH1.duty_index);
-        updateCounter(apu->CH2.counter, apu->CH2.wavelen, apu->CH2.duty_index);
-        updateCounter(apu->CH3.counter, apu->CH3.wavelen, apu->CH3.audioSampleIndexex);
+        if (updateCounter(apu->CH1.counter, apu->CH1.wavelen, apu->CH1.duty_index)) apu->outputDirty = true;
+        if (updateCounter(apu->CH2.counter, apu->CH2.wavelen, apu->CH2.duty_index)) apu->outputDirty = true;
+        if (updateCounter(apu->CH3.counter, apu->CH3.wavelen, apu->CH3.audioSampleIndexex)) apu->outputDirty = true;
     }
 
     if (div % 8 == 0) {
         apu->CH4.counter++;
-        int rate = 2 << ((apu->GB->io[NR43] & static_cast<uint8_t>(APUConstants::NR43::CLOCK_SHIFT_MASK)) >> 4);
-        if (apu->GB->io[NR43] & static_cast<uint8_t>(APUConstants::NR43::DIVISOR_MASK)) {
-            rate *= (apu->GB->io[NR43] & static_cast<uint8_t>(APUConstants::NR43::DIVISOR_MASK));
-        }
-        if (apu->CH4.counter >= rate) {
+        if (apu->CH4.counter >= calculateNoiseRate(apu)) {
             apu->CH4.counter = 0;
-            uint16_t bit = (~(apu->CH4.lfsr ^ (apu->CH4.lfsr >> 1))) & 1;
-            apu->CH4.lfsr = (apu->CH4.lfsr & ~(1 << 15)) | (bit << 15);
-            if (apu->GB->io[NR43] & static_cast<uint8_t>(APUConstants::NR43::WIDTH_MODE_BIT)) {
-                apu->CH4.lfsr = (apu->CH4.lfsr & ~(1 << 7)) | (bit << 7);
-            }
-            apu->CH4.lfsr >>= 1;
-        }
-    }
-
-    if (div % APUConstants::SAMPLE_RATE == 0) {
-        int8_t ch1_sample = apu->CH1.enable ? calculateChannel1Sample(apu) : 0;
-        int8_t ch2_sample = apu->CH2.enable ? calculateChannel2Sample(apu) : 0;
-        int8_t ch3_sample = apu->CH3.enable ? calculateChannel3Sample(apu) : 0;
-        int8_t ch4_sample = apu->CH4.enable ? calculateChannel4Sample(apu) : 0;
-
-        uint8_t l_sample = 0, r_sample = 0;
-
-        uint8_t nr51 = apu->GB->io[NR51];
-        if (nr51 & 0x01) r_sample += ch1_sample;
-        if (nr51 & 0x02) r_sample += ch2_sample;
-        if (nr51 & 0x04) r_sample += ch3_sample;
-        if (nr51 & 0x08) r_sample += ch4_sample;
-        if (nr51 & 0x10) l_sample += ch1_sample;
-        if (nr51 & 0x20) l_sample += ch2_sample;
-        if (nr51 & 0x40) l_sample += ch3_sample;
-        if (nr51 & 0x80) l_sample += ch4_sample;
-
-        uint8_t nr50 = apu->GB->io[NR50];
-        float left_volume = (static_cast<float>(l_sample) / 500.0f) *
-            (static_cast<float>(((nr50 & static_cast<uint8_t>(APUConstants::NR50::LEFT_VOLUME_MASK)) >> 4) + 1));
-        float right_volume = (static_cast<float>(r_sample) / 500.0f) *
-            (static_cast<float>((nr50 & static_cast<uint8_t>(APUConstants::NR50::RIGHT_VOLUME_MASK)) + 1));
-
-        apu->audioSampleBuffer[apu->audioSampleIndex++] = static_cast<float>(left_volume);
-        apu->audioSampleBuffer[apu->audioSampleIndex++] = static_cast<float>(right_volume);
-
-        if (apu->audioSampleIndex >= APUConstants::SAMPLE_BUF_LEN) {
-            apu->isAudioBufferFull = true;
-            apu->audioSampleIndex = 0;
+            apu->CH4.lfsr = stepNoiseLFSR(apu->CH4.lfsr, isNoiseNarrow(apu));
+            apu->outputDirty = true;
         }
     }
 
     if (div % APUConstants::DIV_RATE == 0) {
         apu->apuDivider++;
+        apu->outputDirty = true;
 
         if (apu->apuDivider % 2 == 0) {
 
@@ -194,4 +340,138 @@ void APUClock(GameBoyAPU* apu) {
             updateEnvelope(apu->CH4.env_counter, apu->CH4.env_pace, apu->CH4.env_dir, apu->CH4.volume);
         }
     }
+
+    if (!apu->audioEnabled) return;
+
+    if (apu->outputDirty) {
+        apu->outputDirty = false;
+        updateAPUOutput(apu);
+    }
+    advanceAPUTime(apu);
+}
+
+inline uint32_t cyclesUntilTicks(uint32_t div, uint32_t ticks, uint32_t period) noexcept {
+    return (div / period + ticks) * period - div;
+}
+
+inline uint32_t cyclesUntilWaveTicks(uint32_t div, uint32_t ticks) noexcept {
+    uint32_t target = div / 2 + div / 4 + ticks;
+    return (target / 3) * 4 + (target % 3) * 2 - div;
+}
+
+uint32_t cyclesUntilAPUEvent(const GameBoyAPU* apu, uint32_t div) {
+    if (!apu->audioEnabled) {
+        return isAPUEnabled(apu) ? cyclesUntilTicks(div, 1, APUConstants::DIV_RATE) : APUConstants::DIV_RATE;
+    }
+
+    uint32_t distance = APUConstants::BLIP_FRAME_CYCLES - apu->blipTime;
+    if (!isAPUEnabled(apu)) return distance;
+    if (apu->outputDirty) return 1;
+
+    distance = std::min(distance, cyclesUntilTicks(div, 1, APUConstants::DIV_RATE));
+
+    uint8_t nr51 = apu->GB->io[NR51];
+    if (apu->CH1.enable && apu->CH1.volume && (nr51 & 0x11)) {
+        distance = std::min(distance, cyclesUntilTicks(div, ticksUntilOverflow(apu->CH1.counter, 2048), 4));
+    }
+    if (apu->CH2.enable && apu->CH2.volume && (nr51 & 0x22)) {
+        distance = std::min(distance, cyclesUntilTicks(div, ticksUntilOverflow(apu->CH2.counter, 2048), 4));
+    }
+    if (apu->CH3.enable && (apu->GB->io[NR32] & 0xE0) && (nr51 & 0x44)) {
+        distance = std::min(distance, cyclesUntilWaveTicks(div, ticksUntilOverflow(apu->CH3.counter, 2048)));
+    }
+    if (apu->CH4.enable && apu->CH4.volume && (nr51 & 0x88)) {
+        distance = std::min(distance, cyclesUntilTicks(div, ticksUntilOverflow(apu->CH4.counter, calculateNoiseRate(apu)), 8));
+    }
+    return distance;
+}
+
+void skipAPUCycles(GameBoyAPU* apu, uint32_t div, uint32_t cycles) {
+    if (cycles == 0) return;
+
+    if (!isAPUEnabled(apu)) {
+        apu->GB->io[NR52] = 0;
+        apu->apuDivider = 0;
+        if (apu->audioEnabled) {
+            setAPUOutput(apu, 0.0f, 0.0f);
+            apu->blipTime += cycles;
+        }
+        return;
+    }
+
+    updateChannelStatus(apu);
+
+    uint32_t end = div + cycles;
+    uint32_t squareTicks = end / 4 - div / 4;
+    advanceCounter(apu->CH1.counter, apu->CH1.wavelen, apu->CH1.duty_index, squareTicks);
+    advanceCounter(apu->CH2.counter, apu->CH2.wavelen, apu->CH2.duty_index, squareTicks);
+    advanceCounter(apu->CH3.counter, apu->CH3.wavelen, apu->CH3.audioSampleIndexex, end / 2 - div / 2 + squareTicks);
+
+    uint32_t noiseSteps = advanceNoiseCounter(apu->CH4.counter, calculateNoiseRate(apu), end / 8 - div / 8);
+    if (noiseSteps) {
+        apu->CH4.lfsr = jumpNoiseLFSR(apu->CH4.lfsr, noiseSteps, isNoiseNarrow(apu));
+    }
+
+    if (apu->audioEnabled) {
+        apu->blipTime += cycles;
+    }
+}
+
+void syncAPU(GameBoyAPU* apu) {
+    uint32_t div = static_cast<uint16_t>(apu->GB->div - apu->pendingCycles);
+    uint32_t remaining = apu->pendingCycles;
+    apu->elapsedCycles += remaining;
+
+    while (remaining > 0) {
+        uint32_t skipped = std::min(cyclesUntilAPUEvent(apu, div) - 1, remaining);
+        skipAPUCycles(apu, div, skipped);
+        div += skipped;
+        remaining -= skipped;
+
+        if (remaining > 0) {
+            stepAPU(apu, ++div);
+            remaining--;
+        }
+    }
+
+    apu->pendingCycles = 0;
+    apu->cyclesUntilEvent = cyclesUntilAPUEvent(apu, div);
+}
+
+uint64_t runAPUCycles(GameBoyAPU* apu, uint64_t cycles) {
+    uint64_t run = 0;
+    while (run < cycles && !apu->isAudioBufferFull) {
+        uint32_t chunk = apu->cyclesUntilEvent > apu->pendingCycles
+            ? static_cast<uint32_t>(std::min<uint64_t>(cycles - run, apu->cyclesUntilEvent - apu->pendingCycles))
+            : 1;
+        apu->GB->div = static_cast<uint16_t>(apu->GB->div + chunk);
+        apu->pendingCycles += chunk;
+        if (apu->pendingCycles >= apu->cyclesUntilEvent) syncAPU(apu);
+        run += chunk;
+    }
+    return run;
+}
+
+void setAPUAudioEnabled(GameBoyAPU* apu, bool enabled) {
+    if (apu->audioEnabled == enabled) return;
+
+    syncAPU(apu);
+    apu->audioEnabled = enabled;
+    if (enabled) {
+        clearBlipBuffer(&apu->leftBlip);
+        clearBlipBuffer(&apu->rightBlip);
+        clearResampler(&apu->resampler);
+        apu->blipTime = 0;
+        apu->leftLevel = 0.0f;
+        apu->rightLevel = 0.0f;
+        apu->outputDirty = true;
+        apu->isAudioBufferFull = false;
+    }
+    apu->cyclesUntilEvent = 1;
+}
+
+void notifyAPURegisterWrite(GameBoyAPU* apu) {
+    syncAPU(apu);
+    apu->outputDirty = true;
+    apu->cyclesUntilEvent = 1;
 }
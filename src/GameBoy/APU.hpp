@@ -1,5 +1,8 @@
 #pragma once
 
+#include "BlipBuffer.hpp"
+#include "Resampler.hpp"
+
 #include <cstdint>
 #include <array>
 #include <memory>
@@ -7,9 +10,11 @@
 namespace APUConstants {
     constexpr int BASE_FREQUENCY = 4'194'304;
     constexpr int DIV_RATE = 8192;
-    constexpr int SAMPLE_FREQ = 22050;
-    constexpr int SAMPLE_RATE = BASE_FREQUENCY / SAMPLE_FREQ;
-    constexpr int SAMPLE_BUF_LEN = 1024;
+    constexpr int SAMPLE_FREQ = 48000;
+    constexpr int INTERNAL_SAMPLE_FREQ = BASE_FREQUENCY / 64;
+    constexpr int SAMPLE_BUF_LEN = 256;
+    constexpr int BLIP_FRAME_CYCLES = 4096;
+    constexpr int LFSR_JUMP_LEVELS = 16;
 
     enum class NRX1 : uint8_t {
         LENGTH_MASK = 0b00111111,
@@ -109,8 +114,21 @@ struct GameBoyAPU {
     uint16_t apuDivider = 0;
 
     std::array<float, APUConstants::SAMPLE_BUF_LEN> audioSampleBuffer{};
-    int audioSampleIndex = 0;
     bool isAudioBufferFull = false;
+    bool audioEnabled = true;
+
+    BlipBuffer leftBlip;
+    BlipBuffer rightBlip;
+    uint32_t blipTime = 0;
+    float leftLevel = 0.0f;
+    float rightLevel = 0.0f;
+    bool outputDirty = false;
+    Resampler resampler;
+    int outputFrequency = APUConstants::SAMPLE_FREQ;
+
+    uint32_t pendingCycles = 0;
+    uint32_t cyclesUntilEvent = 1;
+    uint64_t elapsedCycles = 0;
 
     Channel1 CH1;
     Channel2 CH2;
@@ -119,4 +137,9 @@ struct GameBoyAPU {
 
 };
 
-void APUClock(struct GameBoyAPU* apu);
\ No newline at end of file
+void resetAPU(struct GameBoyAPU* apu);
+void setAPUOutputFrequency(struct GameBoyAPU* apu, int frequency);
+void syncAPU(struct GameBoyAPU* apu);
+uint64_t runAPUCycles(struct GameBoyAPU* apu, uint64_t cycles);
+void notifyAPURegisterWrite(struct GameBoyAPU* apu);
+void setAPUAudioEnabled(struct GameBoyAPU* apu, bool enabled);
\ No newline at end of file
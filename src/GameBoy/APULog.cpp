@@ -0,0 +1,345 @@
+#include "APULog.hpp"
+
+#include "APU.hpp"
+#include "GB.hpp"
+#include "Recorder.hpp"
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+constexpr uint64_t APU_LOG_HASH_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t APU_LOG_HASH_PRIME = 0x100000001b3ull;
+
+struct APULogPlayer {
+    GameBoy* gb;
+    std::ofstream wav;
+    uint64_t hash;
+    uint64_t frames;
+};
+
+static void appendLE(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+template <typename T>
+static void appendState(std::vector<uint8_t>& out, const T& state) {
+    appendLE(out, sizeof(T), 2);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&state);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static uint32_t readLE(const uint8_t*& in, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint32_t>(*in++) << (8 * i);
+    }
+    return value;
+}
+
+template <typename T>
+static bool readState(const uint8_t*& in, const uint8_t* end, T* state) {
+    if (end - in < 2 || readLE(in, 2) != sizeof(T) || end - in < static_cast<std::ptrdiff_t>(sizeof(T))) {
+        return false;
+    }
+    std::memcpy(state, in, sizeof(T));
+    in += sizeof(T);
+    return true;
+}
+
+static void apuLogWriterLoop(APULog* log) {
+    while (true) {
+        std::vector<uint8_t> buffer;
+        {
+            std::unique_lock<std::mutex> lock(log->mutex);
+            log->wakeCondition.wait(lock, [&]() { return log->stopping || !log->pendingBuffers.empty(); });
+            if (log->pendingBuffers.empty()) return;
+            buffer = std::move(log->pendingBuffers.front());
+            log->pendingBuffers.pop_front();
+        }
+        log->file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        buffer.clear();
+        {
+            std::lock_guard<std::mutex> lock(log->mutex);
+            log->freeBuffers.push_back(std::move(buffer));
+        }
+    }
+}
+
+static void flushAPULog(APULog* log) {
+    std::vector<uint8_t> next;
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        log->pendingBuffers.push_back(std::move(log->buffer));
+        if (!log->freeBuffers.empty()) {
+            next = std::move(log->freeBuffers.back());
+            log->freeBuffers.pop_back();
+        }
+    }
+    log->wakeCondition.notify_one();
+    next.reserve(APU_LOG_FLUSH_BYTES + 16);
+    log->buffer = std::move(next);
+}
+
+static void joinAPULogWriter(APULog* log) {
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        log->stopping = true;
+    }
+    log->wakeCondition.notify_one();
+    if (log->writerThread.joinable()) log->writerThread.join();
+}
+
+APULog::~APULog() {
+    joinAPULogWriter(this);
+}
+
+static void appendWait(APULog* log, uint64_t cycle) {
+    uint64_t wait = cycle - log->lastCycle;
+    log->lastCycle = cycle;
+    if (wait == 0) return;
+    if (wait <= APU_LOG_SHORT_WAIT_MAX) {
+        log->buffer.push_back(static_cast<uint8_t>(APU_LOG_SHORT_WAIT + wait - 1));
+        return;
+    }
+    log->buffer.push_back(APU_LOG_LONG_WAIT);
+    while (wait >= 0x80) {
+        log->buffer.push_back(static_cast<uint8_t>(wait | 0x80));
+        wait >>= 7;
+    }
+    log->buffer.push_back(static_cast<uint8_t>(wait));
+}
+
+bool isAPULogFile(const std::string& fileName) {
+    std::string extension = std::filesystem::path(fileName).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".apulog";
+}
+
+bool startAPULog(APULog* log, GameBoy* gb, const std::string& fileName) {
+    if (log->active) return true;
+
+    log->file.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!log->file.is_open()) {
+        std::cerr << "Impossible de crer le fichier: " << fileName << std::endl;
+        return false;
+    }
+
+    syncAPU(&gb->apu);
+    log->buffer.clear();
+    log->buffer.insert(log->buffer.end(), APU_LOG_MAGIC, APU_LOG_MAGIC + sizeof(APU_LOG_MAGIC));
+    log->buffer.push_back(APU_LOG_VERSION);
+    appendLE(log->buffer, APUConstants::BASE_FREQUENCY, 4);
+    appendLE(log->buffer, gb->div, 2);
+    appendLE(log->buffer, gb->apu.apuDivider, 2);
+    log->buffer.insert(log->buffer.end(), gb->io + NR10, gb->io + NR10 + APU_LOG_REGISTER_COUNT);
+    appendState(log->buffer, gb->apu.CH1);
+    appendState(log->buffer, gb->apu.CH2);
+    appendState(log->buffer, gb->apu.CH3);
+    appendState(log->buffer, gb->apu.CH4);
+
+    log->lastCycle = gb->apu.elapsedCycles;
+    log->writeCount = 0;
+    log->stopping = false;
+    log->writerThread = std::thread(apuLogWriterLoop, log);
+    log->active = true;
+    gb->apuLog = log;
+    std::cout << "Capture des registres audio dmarre -> " << fileName << std::endl;
+    return true;
+}
+
+void stopAPULog(APULog* log, GameBoy* gb) {
+    if (!log->active) return;
+
+    syncAPU(&gb->apu);
+    appendWait(log, gb->apu.elapsedCycles);
+    log->buffer.push_back(APU_LOG_END);
+    flushAPULog(log);
+    joinAPULogWriter(log);
+    log->file.close();
+    log->active = false;
+    gb->apuLog = nullptr;
+    std::cout << "Capture des registres audio termine (" << log->writeCount << " critures)" << std::endl;
+}
+
+void logAPUWrite(APULog* log, uint64_t cycle, uint16_t addr, uint8_t data) {
+    appendWait(log, cycle);
+    if (addr == (0xFF00 | DIV)) {
+        log->buffer.push_back(APU_LOG_DIV_RESET);
+    }
+    else {
+        log->buffer.push_back(static_cast<uint8_t>(addr - (0xFF00 | NR10)));
+        log->buffer.push_back(data);
+    }
+    log->writeCount++;
+    if (log->buffer.size() >= APU_LOG_FLUSH_BYTES) {
+        flushAPULog(log);
+    }
+}
+
+static void drainAPULogAudio(APULogPlayer* player) {
+    GameBoyAPU* apu = &player->gb->apu;
+    if (!apu->isAudioBufferFull) return;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(apu->audioSampleBuffer.data());
+    for (size_t i = 0; i < sizeof(apu->audioSampleBuffer); i++) {
+        player->hash = (player->hash ^ bytes[i]) * APU_LOG_HASH_PRIME;
+    }
+    player->wav.write(reinterpret_cast<const char*>(bytes), sizeof(apu->audioSampleBuffer));
+    player->frames += APUConstants::SAMPLE_BUF_LEN / 2;
+    apu->isAudioBufferFull = false;
+}
+
+static void advanceAPULog(APULogPlayer* player, uint64_t cycles) {
+    while (cycles > 0) {
+        cycles -= runAPUCycles(&player->gb->apu, cycles);
+        drainAPULogAudio(player);
+    }
+}
+
+APULogResult renderAPULog(const std::string& logPath, const std::string& wavPath, int sampleRate) {
+    APULogResult result = { logPath, false, APU_LOG_HASH_OFFSET, 0, 0.0 };
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream file(logPath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Impossible d'ouvrir le fichier: " << logPath << std::endl;
+        return result;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const uint8_t* in = data.data();
+    const uint8_t* end = data.data() + data.size();
+
+    constexpr size_t fixedHeaderSize = sizeof(APU_LOG_MAGIC) + 1 + 4 + 2 + 2 + APU_LOG_REGISTER_COUNT;
+    if (data.size() < fixedHeaderSize || std::memcmp(in, APU_LOG_MAGIC, sizeof(APU_LOG_MAGIC)) != 0 ||
+        in[sizeof(APU_LOG_MAGIC)] != APU_LOG_VERSION) {
+        std::cerr << "Journal audio invalide: " << logPath << std::endl;
+        return result;
+    }
+    in += sizeof(APU_LOG_MAGIC) + 1;
+    if (readLE(in, 4) != APUConstants::BASE_FREQUENCY) {
+        std::cerr << "Journal audio invalide: " << logPath << std::endl;
+        return result;
+    }
+
+    std::unique_ptr<GameBoy, decltype(&free)> gb(
+        reinterpret_cast<GameBoy*>(calloc(1, sizeof(GameBoy))),
+        &free
+    );
+    if (!gb) {
+        std::cerr << "Erreur d'allocation mmoire pour le systme GB" << std::endl;
+        return result;
+    }
+    resetGameBoy(gb.get(), nullptr);
+    setAPUOutputFrequency(&gb->apu, sampleRate);
+
+    gb->div = static_cast<uint16_t>(readLE(in, 2));
+    gb->apu.apuDivider = static_cast<uint16_t>(readLE(in, 2));
+    std::memcpy(gb->io + NR10, in, APU_LOG_REGISTER_COUNT);
+    in += APU_LOG_REGISTER_COUNT;
+    if (!readState(in, end, &gb->apu.CH1) || !readState(in, end, &gb->apu.CH2) ||
+        !readState(in, end, &gb->apu.CH3) || !readState(in, end, &gb->apu.CH4)) {
+        std::cerr << "Journal audio incompatible avec cette version: " << logPath << std::endl;
+        return result;
+    }
+    notifyAPURegisterWrite(&gb->apu);
+
+    APULogPlayer player = { gb.get(), {}, APU_LOG_HASH_OFFSET, 0 };
+    player.wav.open(wavPath, std::ios::binary | std::ios::trunc);
+    if (!player.wav.is_open()) {
+        std::cerr << "Impossible de crer le fichier: " << wavPath << std::endl;
+        return result;
+    }
+    writeWavHeader(player.wav, sampleRate, 0);
+
+    bool complete = false;
+    while (in < end && !complete) {
+        uint8_t command = *in++;
+        if (command < APU_LOG_REGISTER_COUNT) {
+            if (in == end) break;
+            writeMemoryByte(gb.get(), 0xFF00 | (NR10 + command), *in++);
+        }
+        else if (command == APU_LOG_DIV_RESET) {
+            writeMemoryByte(gb.get(), 0xFF00 | DIV, 0);
+        }
+        else if (command >= APU_LOG_SHORT_WAIT && command < APU_LOG_SHORT_WAIT + APU_LOG_SHORT_WAIT_MAX) {
+            uint64_t wait = command - APU_LOG_SHORT_WAIT + 1;
+            advanceAPULog(&player, wait);
+            result.cycles += wait;
+        }
+        else if (command == APU_LOG_LONG_WAIT) {
+            uint64_t wait = 0;
+            int shift = 0;
+            while (in < end && shift < 64) {
+                uint8_t byte = *in++;
+                wait |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                shift += 7;
+                if (!(byte & 0x80)) break;
+            }
+            advanceAPULog(&player, wait);
+            result.cycles += wait;
+        }
+        else if (command == APU_LOG_END) {
+            complete = true;
+        }
+        else {
+            break;
+        }
+    }
+    if (!complete) {
+        std::cerr << "Journal audio tronqu ou corrompu: " << logPath << std::endl;
+    }
+
+    uint64_t dataBytes = player.frames * 2 * sizeof(float);
+    player.wav.seekp(0, std::ios::beg);
+    writeWavHeader(player.wav, sampleRate, static_cast<uint32_t>(std::min<uint64_t>(dataBytes, UINT32_MAX)));
+    player.wav.close();
+
+    result.rendered = complete && !player.wav.fail();
+    result.hash = player.hash;
+    result.renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool runAPULogRenderer(const std::vector<std::string>& logPaths, int sampleRate) {
+    int count = static_cast<int>(logPaths.size());
+    std::vector<APULogResult> results(count);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkerPool pool;
+        startWorkerPool(&pool, std::min(defaultWorkerCount(1), count - 1));
+        parallelFor(&pool, count, [&](int index) {
+            std::string wavPath = std::filesystem::path(logPaths[index]).replace_extension(".wav").string();
+            results[index] = renderAPULog(logPaths[index], wavPath, sampleRate);
+            });
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool success = true;
+    for (const APULogResult& result : results) {
+        success = success && result.rendered;
+        double seconds = static_cast<double>(result.cycles) / APUConstants::BASE_FREQUENCY;
+        std::ostringstream hash;
+        hash << std::hex << std::setw(16) << std::setfill('0') << result.hash;
+        std::cout << result.path << " : " << hash.str()
+            << " (" << std::fixed << std::setprecision(1) << seconds << " s, x"
+            << static_cast<int>(seconds / std::max(result.renderSeconds, 1e-6)) << " temps rel)"
+            << (result.rendered ? "" : " CHEC") << std::endl;
+    }
+    std::cout << count << " journaux rendus  " << sampleRate << " Hz en "
+        << std::fixed << std::setprecision(2) << elapsed << " s" << std::endl;
+    return success;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr char APU_LOG_MAGIC[8] = { 'G', 'B', 'A', 'P', 'U', 'L', 'O', 'G' };
+constexpr uint8_t APU_LOG_VERSION = 1;
+constexpr uint8_t APU_LOG_REGISTER_COUNT = 0x30;
+constexpr uint8_t APU_LOG_DIV_RESET = 0x30;
+constexpr uint8_t APU_LOG_SHORT_WAIT = 0x40;
+constexpr uint8_t APU_LOG_SHORT_WAIT_MAX = 64;
+constexpr uint8_t APU_LOG_LONG_WAIT = 0x80;
+constexpr uint8_t APU_LOG_END = 0xFF;
+constexpr size_t APU_LOG_FLUSH_BYTES = 64 * 1024;
+
+struct GameBoy;
+
+struct APULog {
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+    uint64_t lastCycle = 0;
+    uint64_t writeCount = 0;
+    bool active = false;
+
+    std::thread writerThread;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::deque<std::vector<uint8_t>> pendingBuffers;
+    std::vector<std::vector<uint8_t>> freeBuffers;
+    bool stopping = false;
+
+    ~APULog();
+};
+
+struct APULogResult {
+    std::string path;
+    bool rendered;
+    uint64_t hash;
+    uint64_t cycles;
+    double renderSeconds;
+};
+
+bool isAPULogFile(const std::string& fileName);
+
+bool startAPULog(APULog* log, GameBoy* gb, const std::string& fileName);
+void stopAPULog(APULog* log, GameBoy* gb);
+void logAPUWrite(APULog* log, uint64_t cycle, uint16_t addr, uint8_t data);
+
+APULogResult renderAPULog(const std::string& logPath, const std::string& wavPath, int sampleRate);
+bool runAPULogRenderer(const std::vector<std::string>& logPaths, int sampleRate);
@@ -0,0 +1,140 @@
+#include "APUThread.hpp"
+
+#include "GB.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+static void runShadowAPU(APUThread* thread, uint64_t cycles) {
+    GameBoyAPU* apu = &thread->shadow->apu;
+    while (cycles > 0) {
+        cycles -= runAPUCycles(apu, cycles);
+        if (apu->isAudioBufferFull) {
+            thread->audioSink(apu->audioSampleBuffer.data());
+            apu->isAudioBufferFull = false;
+        }
+    }
+}
+
+static void wakeAPUThread(APUThread* thread) {
+    thread->wakeSequence.fetch_add(1, std::memory_order_release);
+    thread->wakeSequence.notify_one();
+}
+
+static void apuWorkerLoop(APUThread* thread) {
+    GameBoy* shadow = thread->shadow;
+    uint64_t cycle = thread->renderedCycle.load(std::memory_order_relaxed);
+
+    while (true) {
+        uint32_t wake = thread->wakeSequence.load(std::memory_order_acquire);
+        if (thread->stopping.load(std::memory_order_relaxed)) break;
+
+        uint64_t ready = thread->readyCycle.load(std::memory_order_acquire);
+        if (cycle >= ready) {
+            thread->wakeSequence.wait(wake, std::memory_order_acquire);
+            continue;
+        }
+
+        bool audioEnabled = thread->audioEnabled.load(std::memory_order_relaxed);
+        if (shadow->apu.audioEnabled != audioEnabled) {
+            setAPUAudioEnabled(&shadow->apu, audioEnabled);
+        }
+
+        uint32_t tail = thread->tail.load(std::memory_order_relaxed);
+        uint32_t head = thread->head.load(std::memory_order_acquire);
+        while (true) {
+            while (tail != head && thread->log[tail % APU_WRITE_LOG_CAPACITY].cycle <= cycle) {
+                const APUWrite& write = thread->log[tail % APU_WRITE_LOG_CAPACITY];
+                writeMemoryByte(shadow, write.address, write.value);
+                tail++;
+            }
+            if (cycle >= ready) break;
+
+            uint64_t target = tail != head ? std::min(ready, thread->log[tail % APU_WRITE_LOG_CAPACITY].cycle) : ready;
+            runShadowAPU(thread, target - cycle);
+            cycle = target;
+        }
+
+        thread->tail.store(tail, std::memory_order_release);
+        thread->tail.notify_one();
+        thread->renderedCycle.store(cycle, std::memory_order_release);
+        thread->renderedCycle.notify_one();
+    }
+}
+
+void startAPUThread(GameBoy* gb, std::function<void(const float*)> audioSink) {
+    if (gb->apuThread) return;
+
+    syncAPU(&gb->apu);
+
+    APUThread* thread = new APUThread();
+    thread->GB = gb;
+    thread->audioSink = std::move(audioSink);
+    thread->shadow = reinterpret_cast<GameBoy*>(std::calloc(1, sizeof(GameBoy)));
+    resetGameBoy(thread->shadow, nullptr);
+    std::memcpy(thread->shadow->io, gb->io, sizeof(gb->io));
+    thread->shadow->div = gb->div;
+
+    std::shared_ptr<GameBoy> owner = thread->shadow->apu.GB;
+    thread->shadow->apu = gb->apu;
+    thread->shadow->apu.GB = owner;
+    thread->shadow->apu.cyclesUntilEvent = 1;
+
+    thread->readyCycle.store(gb->apu.elapsedCycles, std::memory_order_relaxed);
+    thread->renderedCycle.store(gb->apu.elapsedCycles, std::memory_order_relaxed);
+    thread->audioEnabled.store(gb->apu.audioEnabled, std::memory_order_relaxed);
+    setAPUAudioEnabled(&gb->apu, false);
+
+    gb->apuThread = thread;
+    thread->worker = std::thread(apuWorkerLoop, thread);
+}
+
+void stopAPUThread(GameBoy* gb) {
+    APUThread* thread = gb->apuThread;
+    if (!thread) return;
+
+    flushAPUThread(gb);
+    uint64_t ready = thread->readyCycle.load(std::memory_order_relaxed);
+    uint64_t rendered;
+    while ((rendered = thread->renderedCycle.load(std::memory_order_acquire)) < ready) {
+        thread->renderedCycle.wait(rendered, std::memory_order_acquire);
+    }
+
+    thread->stopping.store(true, std::memory_order_relaxed);
+    wakeAPUThread(thread);
+    thread->worker.join();
+
+    setAPUAudioEnabled(&gb->apu, thread->audioEnabled.load(std::memory_order_relaxed));
+
+    gb->apuThread = nullptr;
+    std::free(thread->shadow);
+    delete thread;
+}
+
+void logAPUThreadWrite(APUThread* thread, uint64_t cycle, uint16_t address, uint8_t value) {
+    uint32_t head = thread->head.load(std::memory_order_relaxed);
+    uint32_t tail;
+    while (head - (tail = thread->tail.load(std::memory_order_acquire)) == APU_WRITE_LOG_CAPACITY) {
+        thread->readyCycle.store(cycle, std::memory_order_release);
+        wakeAPUThread(thread);
+        thread->tail.wait(tail, std::memory_order_acquire);
+    }
+    thread->log[head % APU_WRITE_LOG_CAPACITY] = { cycle, address, value };
+    thread->head.store(head + 1, std::memory_order_release);
+}
+
+void advanceAPUThread(APUThread* thread, uint64_t cycle) {
+    thread->readyCycle.store(cycle, std::memory_order_release);
+}
+
+void flushAPUThread(GameBoy* gb) {
+    syncAPU(&gb->apu);
+    advanceAPUThread(gb->apuThread, gb->apu.elapsedCycles);
+    wakeAPUThread(gb->apuThread);
+}
+
+void setAPUThreadAudioEnabled(APUThread* thread, bool enabled) {
+    thread->audioEnabled.store(enabled, std::memory_order_relaxed);
+}
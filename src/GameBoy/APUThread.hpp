@@ -0,0 +1,48 @@
+#pragma once
+
+#include "APU.hpp"
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+constexpr uint32_t APU_WRITE_LOG_CAPACITY = 1 << 14;
+
+struct GameBoy;
+
+struct APUWrite {
+    uint64_t cycle;
+    uint16_t address;
+    uint8_t value;
+};
+
+struct APUThread {
+    GameBoy* GB;
+    GameBoy* shadow;
+
+    std::array<APUWrite, APU_WRITE_LOG_CAPACITY> log;
+    std::atomic<uint32_t> head = 0;
+    std::atomic<uint32_t> tail = 0;
+
+    std::atomic<uint64_t> readyCycle = 0;
+    std::atomic<uint64_t> renderedCycle = 0;
+    std::atomic<uint32_t> wakeSequence = 0;
+
+    std::function<void(const float*)> audioSink;
+
+    std::atomic<bool> audioEnabled = true;
+
+    std::atomic<bool> stopping = false;
+    std::thread worker;
+};
+
+void startAPUThread(GameBoy* gb, std::function<void(const float*)> audioSink);
+void stopAPUThread(GameBoy* gb);
+
+void logAPUThreadWrite(APUThread* thread, uint64_t cycle, uint16_t address, uint8_t value);
+void advanceAPUThread(APUThread* thread, uint64_t cycle);
+void flushAPUThread(GameBoy* gb);
+
+void setAPUThreadAudioEnabled(APUThread* thread, bool enabled);
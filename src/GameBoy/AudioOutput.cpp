@@ -0,0 +1,180 @@
+#include "AudioOutput.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+static uint32_t latencyToFrames(int sampleRate, int latencyMs) {
+    latencyMs = std::clamp(latencyMs, AUDIO_MIN_LATENCY_MS, AUDIO_MAX_LATENCY_MS);
+    return std::min<uint32_t>(static_cast<uint32_t>(sampleRate) * latencyMs / 1000, AUDIO_RING_FRAMES / 2);
+}
+
+static void fillHeldFrames(const AudioOutput* output, float* out, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++) {
+        std::memcpy(out + i * AUDIO_CHANNELS, output->lastFrame.data(), sizeof(output->lastFrame));
+    }
+}
+
+static void SDLCALL audioCallback(void* userdata, Uint8* stream, int length) {
+    AudioOutput* output = static_cast<AudioOutput*>(userdata);
+    float* out = reinterpret_cast<float*>(stream);
+    uint32_t requested = static_cast<uint32_t>(length) / (sizeof(float) * AUDIO_CHANNELS);
+
+    uint32_t tail = output->tail.load(std::memory_order_relaxed);
+    uint32_t available = output->head.load(std::memory_order_acquire) - tail;
+
+    if (!output->primed) {
+        if (available < output->targetFrames.load(std::memory_order_relaxed)) {
+            fillHeldFrames(output, out, requested);
+            return;
+        }
+        output->primed = true;
+    }
+
+    uint32_t frames = std::min(available, requested);
+    uint32_t start = tail % AUDIO_RING_FRAMES;
+    uint32_t first = std::min(frames, AUDIO_RING_FRAMES - start);
+    std::memcpy(out, output->ring.data() + start * AUDIO_CHANNELS, first * AUDIO_CHANNELS * sizeof(float));
+    std::memcpy(out + first * AUDIO_CHANNELS, output->ring.data(), (frames - first) * AUDIO_CHANNELS * sizeof(float));
+    output->tail.store(tail + frames, std::memory_order_release);
+
+    if (frames > 0) {
+        std::memcpy(output->lastFrame.data(), out + (frames - 1) * AUDIO_CHANNELS, sizeof(output->lastFrame));
+    }
+    if (frames < requested) {
+        output->underruns.fetch_add(1, std::memory_order_relaxed);
+        output->primed = false;
+        fillHeldFrames(output, out + frames * AUDIO_CHANNELS, requested - frames);
+    }
+}
+
+AudioOutput::~AudioOutput() {
+    closeAudioOutput(this);
+}
+
+bool openAudioOutput(AudioOutput* output, int sampleRate, int latencyMs) {
+    closeAudioOutput(output);
+
+    output->sampleRate = sampleRate;
+    setAudioLatency(output, latencyMs);
+    output->head.store(0, std::memory_order_relaxed);
+    output->tail.store(0, std::memory_order_relaxed);
+    output->primed = false;
+    output->lastFrame.fill(0.0f);
+    output->underruns.store(0, std::memory_order_relaxed);
+    output->overruns.store(0, std::memory_order_relaxed);
+
+    uint32_t callbackFrames = AUDIO_MIN_CALLBACK_FRAMES;
+    while (callbackFrames * 4 <= output->targetFrames.load(std::memory_order_relaxed)) {
+        callbackFrames *= 2;
+    }
+
+    SDL_AudioSpec desiredSpec = {};
+    desiredSpec.freq = sampleRate;
+    desiredSpec.format = AUDIO_F32;
+    desiredSpec.channels = AUDIO_CHANNELS;
+    desiredSpec.samples = static_cast<Uint16>(callbackFrames);
+    desiredSpec.callback = audioCallback;
+    desiredSpec.userdata = output;
+
+    SDL_AudioSpec obtainedSpec = desiredSpec;
+    output->device = SDL_OpenAudioDevice(nullptr, 0, &desiredSpec, &obtainedSpec, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (output->device == 0) {
+        return false;
+    }
+    output->sampleRate = obtainedSpec.freq;
+    setAudioLatency(output, latencyMs);
+    SDL_PauseAudioDevice(output->device, 0);
+    return true;
+}
+
+void closeAudioOutput(AudioOutput* output) {
+    if (output->device == 0) return;
+    SDL_CloseAudioDevice(output->device);
+    output->device = 0;
+}
+
+void setAudioLatency(AudioOutput* output, int latencyMs) {
+    output->targetFrames.store(latencyToFrames(output->sampleRate, latencyMs), std::memory_order_relaxed);
+}
+
+uint32_t writeAudioFrames(AudioOutput* output, const float* samples, uint32_t frames) {
+    uint32_t head = output->head.load(std::memory_order_relaxed);
+    uint32_t space = AUDIO_RING_FRAMES - (head - output->tail.load(std::memory_order_acquire));
+    if (frames > space) {
+        output->overruns.fetch_add(1, std::memory_order_relaxed);
+        frames = space;
+    }
+
+    uint32_t start = head % AUDIO_RING_FRAMES;
+    uint32_t first = std::min(frames, AUDIO_RING_FRAMES - start);
+    std::memcpy(output->ring.data() + start * AUDIO_CHANNELS, samples, first * AUDIO_CHANNELS * sizeof(float));
+    std::memcpy(output->ring.data(), samples + first * AUDIO_CHANNELS, (frames - first) * AUDIO_CHANNELS * sizeof(float));
+    output->head.store(head + frames, std::memory_order_release);
+    return frames;
+}
+
+uint32_t getAudioFill(const AudioOutput* output) {
+    return output->head.load(std::memory_order_acquire) - output->tail.load(std::memory_order_acquire);
+}
+
+int getAudioFillMilliseconds(const AudioOutput* output) {
+    if (output->sampleRate == 0) return 0;
+    return static_cast<int>(getAudioFill(output) * 1000ull / output->sampleRate);
+}
+
+void waitForAudioDrain(AudioOutput* output) {
+    if (output->device == 0) return;
+    uint32_t fill = getAudioFill(output);
+    uint32_t target = output->targetFrames.load(std::memory_order_relaxed);
+    if (fill <= target) return;
+    std::this_thread::sleep_for(std::chrono::microseconds((fill - target) * 1000000ull / output->sampleRate));
+}
+
+void limitAudioBacklog(AudioOutput* output) {
+    if (getAudioFill(output) > AUDIO_BACKLOG_FACTOR * output->targetFrames.load(std::memory_order_relaxed)) {
+        waitForAudioDrain(output);
+    }
+}
+
+double getAudioRateCorrection(const AudioOutput* output) {
+    double target = output->targetFrames.load(std::memory_order_relaxed);
+    if (output->device == 0 || target == 0.0) return 1.0;
+    double error = std::clamp((static_cast<double>(getAudioFill(output)) - target) / target, -1.0, 1.0);
+    return 1.0 - AUDIO_RATE_CONTROL_DELTA * error;
+}
+
+void initAudioRateConverter(AudioRateConverter* converter, int sampleRate) {
+    converter->sampleRate = sampleRate;
+    converter->resampler = std::make_unique<Resampler>();
+    initResampler(converter->resampler.get(), sampleRate, sampleRate);
+    converter->ratio.store(1.0, std::memory_order_relaxed);
+}
+
+void setAudioRateRatio(AudioRateConverter* converter, double ratio) {
+    converter->ratio.store(ratio, std::memory_order_relaxed);
+}
+
+const float* convertAudioRate(AudioRateConverter* converter, const float* samples, uint32_t frames, uint32_t* outputFrames) {
+    Resampler* resampler = converter->resampler.get();
+    setResamplerRatio(resampler, converter->sampleRate, converter->sampleRate * converter->ratio.load(std::memory_order_relaxed));
+
+    converter->output.clear();
+    uint32_t offset = 0;
+    while (offset < frames) {
+        int chunk = std::min<int>(frames - offset, RESAMPLER_HISTORY - resampler->buffered);
+        for (int i = 0; i < chunk; i++) {
+            resampler->left[resampler->buffered + i] = samples[(offset + i) * AUDIO_CHANNELS];
+            resampler->right[resampler->buffered + i] = samples[(offset + i) * AUDIO_CHANNELS + 1];
+        }
+        int available = resamplerOutputAvailable(resampler, chunk);
+        size_t start = converter->output.size();
+        converter->output.resize(start + static_cast<size_t>(available) * AUDIO_CHANNELS);
+        resampleFrames(resampler, chunk, converter->output.data() + start, available);
+        offset += chunk;
+    }
+
+    *outputFrames = static_cast<uint32_t>(converter->output.size() / AUDIO_CHANNELS);
+    return converter->output.data();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Resampler.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+constexpr uint32_t AUDIO_RING_FRAMES = 8192;
+constexpr int AUDIO_CHANNELS = 2;
+constexpr int AUDIO_DEFAULT_LATENCY_MS = 40;
+constexpr int AUDIO_MIN_LATENCY_MS = 20;
+constexpr int AUDIO_MAX_LATENCY_MS = 250;
+constexpr int AUDIO_MIN_CALLBACK_FRAMES = 64;
+constexpr double AUDIO_RATE_CONTROL_DELTA = 0.005;
+constexpr uint32_t AUDIO_BACKLOG_FACTOR = 4;
+
+struct AudioOutput {
+    SDL_AudioDeviceID device = 0;
+    int sampleRate = 0;
+    std::atomic<uint32_t> targetFrames = 0;
+
+    std::array<float, AUDIO_RING_FRAMES * AUDIO_CHANNELS> ring{};
+    std::atomic<uint32_t> head = 0;
+    std::atomic<uint32_t> tail = 0;
+
+    bool primed = false;
+    std::array<float, AUDIO_CHANNELS> lastFrame{};
+
+    std::atomic<uint32_t> underruns = 0;
+    std::atomic<uint32_t> overruns = 0;
+
+    ~AudioOutput();
+};
+
+struct AudioRateConverter {
+    std::unique_ptr<Resampler> resampler;
+    std::vector<float> output;
+    double sampleRate = 0.0;
+    std::atomic<double> ratio = 1.0;
+};
+
+bool openAudioOutput(AudioOutput* output, int sampleRate, int latencyMs);
+void closeAudioOutput(AudioOutput* output);
+void setAudioLatency(AudioOutput* output, int latencyMs);
+
+uint32_t writeAudioFrames(AudioOutput* output, const float* samples, uint32_t frames);
+uint32_t getAudioFill(const AudioOutput* output);
+int getAudioFillMilliseconds(const AudioOutput* output);
+void waitForAudioDrain(AudioOutput* output);
+void limitAudioBacklog(AudioOutput* output);
+double getAudioRateCorrection(const AudioOutput* output);
+
+void initAudioRateConverter(AudioRateConverter* converter, int sampleRate);
+void setAudioRateRatio(AudioRateConverter* converter, double ratio);
+const float* convertAudioRate(AudioRateConverter* converter, const float* samples, uint32_t frames, uint32_t* outputFrames);
\ No newline at end of file
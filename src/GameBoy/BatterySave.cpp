@@ -0,0 +1,188 @@
+#include "BatterySave.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+static bool mapBatterySave(BatterySave* save, const std::string& fileName) {
+    HANDLE hFile = CreateFileA(
+        fileName.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+
+    if (hFile == INVALID_HANDLE_VALUE) {
+        std::cerr << "Erreur lors de l'ouverture du fichier .sav: " << fileName << std::endl;
+        return false;
+    }
+    save->file = hFile;
+
+    LARGE_INTEGER liSize;
+    liSize.QuadPart = static_cast<LONGLONG>(save->size);
+    if (!SetFilePointerEx(hFile, liSize, nullptr, FILE_BEGIN) ||
+        !SetEndOfFile(hFile)) {
+        std::cerr << "Erreur lors de la dfinition de la taille du fichier .sav." << std::endl;
+        return false;
+    }
+
+    HANDLE hMap = CreateFileMappingA(hFile, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (!hMap) {
+        std::cerr << "Erreur lors de la cration du mapping de fichier." << std::endl;
+        return false;
+    }
+
+    LPVOID mappedView = MapViewOfFile(hMap, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, save->size);
+    CloseHandle(hMap);
+    if (!mappedView) {
+        std::cerr << "Erreur lors du mappage de la vue du fichier .sav." << std::endl;
+        return false;
+    }
+
+    save->data = reinterpret_cast<uint8_t*>(mappedView);
+    return true;
+}
+
+static void syncBatterySaveRange(BatterySave* save, size_t offset, size_t length) {
+    FlushViewOfFile(save->data + offset, length);
+}
+
+static void syncBatterySaveFile(BatterySave* save) {
+    FlushFileBuffers(save->file);
+}
+
+static void unmapBatterySave(BatterySave* save) {
+    if (save->data) {
+        UnmapViewOfFile(save->data);
+    }
+    if (save->file) {
+        CloseHandle(save->file);
+    }
+}
+#else
+static bool mapBatterySave(BatterySave* save, const std::string& fileName) {
+    save->fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (save->fd < 0) {
+        std::cerr << "Erreur lors de l'ouverture du fichier .sav: " << fileName << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(save->fd, &st) != 0 ||
+        (static_cast<size_t>(st.st_size) != save->size && ftruncate(save->fd, save->size) != 0)) {
+        std::cerr << "Erreur lors de la dfinition de la taille du fichier .sav." << std::endl;
+        return false;
+    }
+
+    void* mappedView = mmap(nullptr, save->size, PROT_READ | PROT_WRITE, MAP_SHARED, save->fd, 0);
+    if (mappedView == MAP_FAILED) {
+        std::cerr << "Erreur lors du mappage de la vue du fichier .sav." << std::endl;
+        return false;
+    }
+
+    save->data = reinterpret_cast<uint8_t*>(mappedView);
+    return true;
+}
+
+static void syncBatterySaveRange(BatterySave* save, size_t offset, size_t length) {
+    size_t pageMask = static_cast<size_t>(sysconf(_SC_PAGESIZE)) - 1;
+    size_t start = offset & ~pageMask;
+    msync(save->data + start, offset + length - start, MS_SYNC);
+}
+
+static void syncBatterySaveFile(BatterySave* save) {
+    fdatasync(save->fd);
+}
+
+static void unmapBatterySave(BatterySave* save) {
+    if (save->data) {
+        munmap(save->data, save->size);
+    }
+    if (save->fd >= 0) {
+        close(save->fd);
+    }
+}
+#endif
+
+static void flushDirtyBanks(BatterySave* save) {
+    uint32_t dirty = save->dirtyBanks.exchange(0, std::memory_order_acquire);
+    if (!dirty) return;
+
+    for (uint32_t bank = 0; dirty; bank++, dirty >>= 1) {
+        if (!(dirty & 1)) continue;
+        size_t offset = static_cast<size_t>(bank) * BATTERY_SAVE_BANK_SIZE;
+        if (offset >= save->size) break;
+        syncBatterySaveRange(save, offset, std::min<size_t>(BATTERY_SAVE_BANK_SIZE, save->size - offset));
+    }
+    syncBatterySaveFile(save);
+}
+
+static void batterySaveLoop(BatterySave* save) {
+    auto interval = std::chrono::milliseconds(BATTERY_SAVE_FLUSH_INTERVAL_MS);
+    auto nextFlush = std::chrono::steady_clock::now() + interval;
+
+    while (!save->stopRequested.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> lock(save->mutex);
+            save->wakeCondition.wait_until(lock, nextFlush, [save]() {
+                return save->flushRequested.load(std::memory_order_acquire) ||
+                    save->stopRequested.load(std::memory_order_acquire);
+                });
+        }
+        save->flushRequested.store(false, std::memory_order_relaxed);
+        flushDirtyBanks(save);
+        nextFlush = std::chrono::steady_clock::now() + interval;
+    }
+
+    flushDirtyBanks(save);
+}
+
+BatterySave* openBatterySave(const std::string& fileName, size_t size) {
+    auto save = std::make_unique<BatterySave>();
+    save->size = size;
+    if (!mapBatterySave(save.get(), fileName)) {
+        unmapBatterySave(save.get());
+        return nullptr;
+    }
+
+    save->flushThread = std::thread(batterySaveLoop, save.get());
+    return save.release();
+}
+
+void closeBatterySave(BatterySave* save) {
+    if (!save) return;
+
+    {
+        std::lock_guard<std::mutex> lock(save->mutex);
+        save->stopRequested.store(true, std::memory_order_release);
+    }
+    save->wakeCondition.notify_one();
+    if (save->flushThread.joinable()) {
+        save->flushThread.join();
+    }
+
+    unmapBatterySave(save);
+    delete save;
+}
+
+void requestBatterySaveFlush(BatterySave* save) {
+    if (save->flushRequested.load(std::memory_order_relaxed)) return;
+    {
+        std::lock_guard<std::mutex> lock(save->mutex);
+        save->flushRequested.store(true, std::memory_order_release);
+    }
+    save->wakeCondition.notify_one();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+constexpr uint32_t BATTERY_SAVE_BANK_SIZE = 8 * 1024;
+constexpr int BATTERY_SAVE_FLUSH_INTERVAL_MS = 2000;
+
+struct BatterySave {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void* file = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    std::atomic<uint32_t> dirtyBanks = 0;
+    std::atomic<bool> flushRequested = false;
+    std::atomic<bool> stopRequested = false;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::thread flushThread;
+};
+
+BatterySave* openBatterySave(const std::string& fileName, size_t size);
+void closeBatterySave(BatterySave* save);
+
+void requestBatterySaveFlush(BatterySave* save);
+
+inline void markBatterySaveDirty(BatterySave* save, uint32_t offset) {
+    uint32_t bit = 1u << ((offset / BATTERY_SAVE_BANK_SIZE) & 31);
+    if (!(save->dirtyBanks.load(std::memory_order_relaxed) & bit)) {
+        save->dirtyBanks.fetch_or(bit, std::memory_order_relaxed);
+    }
+}
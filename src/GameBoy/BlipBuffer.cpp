@@ -0,0 +1,84 @@
+#include "BlipBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+constexpr double BLIP_CUTOFF = 0.9;
+constexpr double BLIP_PI = 3.14159265358979323846;
+
+using BlipKernel = std::array<std::array<float, BLIP_KERNEL_WIDTH>, BLIP_PHASE_COUNT>;
+
+static const BlipKernel& blipKernel() {
+    static const BlipKernel kernel = []() {
+        BlipKernel values{};
+        constexpr double half = BLIP_KERNEL_WIDTH / 2;
+        for (int phase = 0; phase < BLIP_PHASE_COUNT; phase++) {
+            double fraction = static_cast<double>(phase) / BLIP_PHASE_COUNT;
+            double sum = 0.0;
+            for (int tap = 0; tap < BLIP_KERNEL_WIDTH; tap++) {
+                double x = tap - (half - 1) - fraction;
+                double sinc = x == 0.0 ? 1.0 : std::sin(BLIP_PI * BLIP_CUTOFF * x) / (BLIP_PI * BLIP_CUTOFF * x);
+                double window = 0.42 + 0.5 * std::cos(BLIP_PI * x / half) + 0.08 * std::cos(2.0 * BLIP_PI * x / half);
+                double value = std::abs(x) < half ? sinc * window : 0.0;
+                values[phase][tap] = static_cast<float>(value);
+                sum += value;
+            }
+            for (float& value : values[phase]) {
+                value = static_cast<float>(value / sum);
+            }
+        }
+        return values;
+        }();
+    return kernel;
+}
+
+void clearBlipBuffer(BlipBuffer* blip) {
+    blip->offset = 0;
+    blip->available = 0;
+    blip->integrator = 0.0f;
+    blip->deltas.fill(0.0f);
+}
+
+void setBlipRates(BlipBuffer* blip, double clockRate, double sampleRate) {
+    blip->factor = static_cast<uint64_t>(sampleRate / clockRate * static_cast<double>(1ull << BLIP_TIME_BITS) + 0.5);
+}
+
+void addBlipDelta(BlipBuffer* blip, uint32_t clockTime, float delta) {
+    uint64_t fixed = clockTime * blip->factor + blip->offset;
+    size_t position = std::min(blip->available + static_cast<size_t>(fixed >> BLIP_TIME_BITS), static_cast<size_t>(BLIP_BUFFER_CAPACITY));
+
+    int phase = static_cast<int>(fixed >> (BLIP_TIME_BITS - BLIP_PHASE_BITS)) & (BLIP_PHASE_COUNT - 1);
+    const std::array<float, BLIP_KERNEL_WIDTH>& kernel = blipKernel()[phase];
+    float* out = &blip->deltas[position];
+    for (int tap = 0; tap < BLIP_KERNEL_WIDTH; tap++) {
+        out[tap] += kernel[tap] * delta;
+    }
+}
+
+void endBlipFrame(BlipBuffer* blip, uint32_t clockDuration) {
+    uint64_t fixed = clockDuration * blip->factor + blip->offset;
+    blip->available = std::min(blip->available + static_cast<int>(fixed >> BLIP_TIME_BITS), BLIP_BUFFER_CAPACITY);
+    blip->offset = fixed & ((1ull << BLIP_TIME_BITS) - 1);
+}
+
+int blipSamplesAvailable(const BlipBuffer* blip) {
+    return blip->available;
+}
+
+int readBlipSamples(BlipBuffer* blip, float* out, int count, int stride) {
+    count = std::min(count, blip->available);
+    float integrator = blip->integrator;
+    for (int i = 0; i < count; i++) {
+        integrator += blip->deltas[i];
+        out[i * stride] = integrator;
+        integrator -= integrator * BLIP_HIGH_PASS;
+    }
+    blip->integrator = integrator;
+
+    size_t remaining = blip->deltas.size() - count;
+    std::memmove(blip->deltas.data(), blip->deltas.data() + count, remaining * sizeof(float));
+    std::fill(blip->deltas.begin() + remaining, blip->deltas.end(), 0.0f);
+    blip->available -= count;
+    return count;
+}
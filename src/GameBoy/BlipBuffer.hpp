@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+constexpr int BLIP_PHASE_BITS = 6;
+constexpr int BLIP_PHASE_COUNT = 1 << BLIP_PHASE_BITS;
+constexpr int BLIP_KERNEL_WIDTH = 16;
+constexpr int BLIP_BUFFER_CAPACITY = 2048;
+constexpr int BLIP_TIME_BITS = 32;
+constexpr float BLIP_HIGH_PASS = 1.0f / 512.0f;
+
+struct BlipBuffer {
+    uint64_t factor;
+    uint64_t offset;
+    int available;
+    float integrator;
+    std::array<float, BLIP_BUFFER_CAPACITY + BLIP_KERNEL_WIDTH> deltas;
+};
+
+void clearBlipBuffer(BlipBuffer* blip);
+void setBlipRates(BlipBuffer* blip, double clockRate, double sampleRate);
+
+void addBlipDelta(BlipBuffer* blip, uint32_t clockTime, float delta);
+void endBlipFrame(BlipBuffer* blip, uint32_t clockDuration);
+
+int blipSamplesAvailable(const BlipBuffer* blip);
+int readBlipSamples(BlipBuffer* blip, float* out, int count, int stride);
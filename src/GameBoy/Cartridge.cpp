@@ -1,222 +1,184 @@
 #include "Cartridge.hpp"
 
+#include "BatterySave.hpp"
+#include "RomImage.hpp"
+
 #include <cstring>
+#include <ctime>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
-#include <vector>
-#include <windows.h>
 
-struct HandleDeleter {
-    void operator()(HANDLE handle) const {
-        if (handle && handle != INVALID_HANDLE_VALUE) {
-            CloseHandle(handle);
-        }
+static void prefetchROMBank(Cartridge* Cart, int bank) {
+    if (Cart->image) {
+        prefetchRomImageBank(Cart->image, bank);
     }
-};
-
-using unique_handle = std::unique_ptr<std::remove_pointer<HANDLE>::type, HandleDeleter>;
-
-std::string generateSAVFilename(const std::string& fileName) {
-    std::filesystem::path path(fileName);
-    return path.replace_extension(".sav").string();
 }
 
-Cartridge* createCartridge(const char* fileName)
-{
-    std::ifstream file(fileName, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Impossible d'ouvrir le fichier: " << fileName << std::endl;
-        return nullptr;
-    }
+constexpr uint64_t RTC_DAY_CYCLES = 86400ull * CARTRIDGE_CLOCK_FREQ;
+constexpr uint8_t RTC_REGISTER_MASKS[RTC_REGISTER_COUNT] = { 0x3F, 0x3F, 0x1F, 0xFF, RTC_CARRY | RTC_HALT | RTC_DAY_HIGH };
 
-    file.seekg(0x0147, std::ios::beg);
-    std::vector<uint8_t> headerData(3);
-    file.read(reinterpret_cast<char*>(headerData.data()), headerData.size());
-    if (file.gcount() < static_cast<std::streamsize>(headerData.size())) {
-        std::cerr << "Erreur de lecture de l'en-tte du fichier." << std::endl;
-        return nullptr;
+static void syncRTC(Cartridge* Cart) {
+    if (!Cart->MBC3.rtcHalted && Cart->clockCycles > Cart->MBC3.rtcSyncCycle) {
+        Cart->MBC3.rtcCycles += Cart->clockCycles - Cart->MBC3.rtcSyncCycle;
     }
+    Cart->MBC3.rtcSyncCycle = Cart->clockCycles;
 
-    file.seekg(0, std::ios::beg);
-
-    MBC Mapper;
-    uint8_t MapperCode = headerData[0];
-    if (MapperCode == 0 || MapperCode == 0x08 || MapperCode == 0x09)
-        Mapper = MBC::MBC0;
-    else if (MapperCode >= 0x01 && MapperCode <= 0x03)
-        Mapper = MBC::MBC1;
-    else if (MapperCode == 0x05 || MapperCode == 0x06)
-        Mapper = MBC::MBC2;
-    else if (MapperCode >= 0x0f && MapperCode <= 0x13)
-        Mapper = MBC::MBC3;
-    else if (MapperCode >= 0x19 && MapperCode <= 0x1e)
-        Mapper = MBC::MBC5;
-    else {
-        std::cerr << "Mapper non support: " << static_cast<int>(MapperCode) << std::endl;
-        return nullptr;
+    if (Cart->MBC3.rtcCycles >= 512 * RTC_DAY_CYCLES) {
+        Cart->MBC3.rtcCycles %= 512 * RTC_DAY_CYCLES;
+        Cart->MBC3.rtcCarry = true;
     }
+}
 
-    bool Battery = false;
-    switch (MapperCode) {
-    case 0x03:
-    case 0x06:
-    case 0x09:
-    case 0x0d:
-    case 0x0f:
-    case 0x10:
-    case 0x13:
-    case 0x1b:
-    case 0x1e:
-    case 0x22:
-        Battery = true;
-        break;
-    default:
-        Battery = false;
-        break;
-    }
+static void getRTCRegisters(const Cartridge* Cart, uint8_t* regs) {
+    uint64_t seconds = Cart->MBC3.rtcCycles / CARTRIDGE_CLOCK_FREQ;
+    uint64_t days = seconds / 86400;
+    regs[RTC_S] = static_cast<uint8_t>(seconds % 60);
+    regs[RTC_M] = static_cast<uint8_t>(seconds / 60 % 60);
+    regs[RTC_H] = static_cast<uint8_t>(seconds / 3600 % 24);
+    regs[RTC_DL] = static_cast<uint8_t>(days);
+    regs[RTC_DH] = static_cast<uint8_t>((days >> 8) & RTC_DAY_HIGH) |
+        (Cart->MBC3.rtcHalted ? RTC_HALT : 0) |
+        (Cart->MBC3.rtcCarry ? RTC_CARRY : 0);
+}
 
-    int romBanks = (headerData[1] <= 8) ? (2 << headerData[1]) : -1;
-    if (romBanks == -1) {
-        std::cerr << "Nombre de banques ROM invalide: " << static_cast<int>(headerData[1]) << std::endl;
-        return nullptr;
-    }
+static void setRTCRegisters(Cartridge* Cart, const uint8_t* regs, uint64_t subsecondCycles) {
+    uint64_t days = regs[RTC_DL] | ((regs[RTC_DH] & RTC_DAY_HIGH) << 8);
+    uint64_t seconds = ((days * 24 + regs[RTC_H]) * 60 + regs[RTC_M]) * 60 + regs[RTC_S];
+    Cart->MBC3.rtcCycles = seconds * CARTRIDGE_CLOCK_FREQ + subsecondCycles;
+    Cart->MBC3.rtcHalted = regs[RTC_DH] & RTC_HALT;
+    Cart->MBC3.rtcCarry = regs[RTC_DH] & RTC_CARRY;
+}
 
-    int ramBanks;
-    switch (headerData[2]) {
-    case 0:
-    case 1:
-        ramBanks = 0;
-        break;
-    case 2:
-        ramBanks = 1;
-        break;
-    case 3:
-        ramBanks = 4;
-        break;
-    case 4:
-        ramBanks = 16;
-        break;
-    case 5:
-        ramBanks = 8;
-        break;
-    default:
-        std::cerr << "Nombre de banques RAM invalide: " << static_cast<int>(headerData[2]) << std::endl;
-        return nullptr;
-    }
+static void writeRTCFooter(Cartridge* Cart) {
+    if (!Cart->save) return;
 
-    auto Cart = std::make_unique<Cartridge>();
-    Cart->Mapper = Mapper;
-    Cart->hasBatteryBackup = Battery;
-    Cart->romBanks = romBanks;
-    Cart->ramBanks = ramBanks;
-
-    std::vector<uint8_t> rom_Data(romBanks * ROM_BANK_SIZE);
-    file.read(reinterpret_cast<char*>(rom_Data.data()), rom_Data.size());
-    if (file.gcount() < static_cast<std::streamsize>(rom_Data.size())) {
-        std::cerr << "Erreur de lecture des donnes ROM." << std::endl;
-        return nullptr;
+    uint8_t regs[RTC_REGISTER_COUNT];
+    getRTCRegisters(Cart, regs);
+
+    size_t offset = static_cast<size_t>(Cart->ramBanks) * ERAM_BANK_SIZE;
+    uint8_t* footer = Cart->save->data + offset;
+    for (int i = 0; i < RTC_REGISTER_COUNT; i++) {
+        uint32_t current = regs[i];
+        uint32_t latched = Cart->MBC3.latchedRTC[i];
+        std::memcpy(footer + i * 4, &current, 4);
+        std::memcpy(footer + (RTC_REGISTER_COUNT + i) * 4, &latched, 4);
     }
+    int64_t timestamp = static_cast<int64_t>(std::time(nullptr));
+    std::memcpy(footer + RTC_REGISTER_COUNT * 8, &timestamp, 8);
+    markBatterySaveDirty(Cart->save, static_cast<uint32_t>(offset));
+}
 
-    uint8_t(*rom)[ROM_BANK_SIZE] = reinterpret_cast<uint8_t(*)[ROM_BANK_SIZE]>(
-        std::malloc(romBanks * ROM_BANK_SIZE));
-    if (!rom) {
-        std::cerr << "chec de l'allocation de la mmoire ROM." << std::endl;
-        return nullptr;
+static void readRTCFooter(Cartridge* Cart) {
+    const uint8_t* footer = Cart->save->data + static_cast<size_t>(Cart->ramBanks) * ERAM_BANK_SIZE;
+    uint8_t regs[RTC_REGISTER_COUNT];
+    for (int i = 0; i < RTC_REGISTER_COUNT; i++) {
+        uint32_t current, latched;
+        std::memcpy(&current, footer + i * 4, 4);
+        std::memcpy(&latched, footer + (RTC_REGISTER_COUNT + i) * 4, 4);
+        regs[i] = static_cast<uint8_t>(current) & RTC_REGISTER_MASKS[i];
+        Cart->MBC3.latchedRTC[i] = static_cast<uint8_t>(latched) & RTC_REGISTER_MASKS[i];
     }
-    std::memcpy(rom, rom_Data.data(), rom_Data.size());
-    Cart->rom = rom;
-
-    if (ramBanks > 0) {
-        if (Battery) {
-            std::string sav_filename = generateSAVFilename(fileName);
-            unique_handle hSavFile(CreateFileA(
-                sav_filename.c_str(),
-                GENERIC_READ | GENERIC_WRITE,
-                FILE_SHARE_READ,
-                nullptr,
-                OPEN_ALWAYS,
-                FILE_ATTRIBUTE_NORMAL,
-                nullptr));
-
-            if (hSavFile.get() == INVALID_HANDLE_VALUE) {
-                std::cerr << "Erreur lors de l'ouverture du fichier .sav: " << sav_filename << std::endl;
-                std::free(Cart->rom);
-                return nullptr;
-            }
+    int64_t timestamp;
+    std::memcpy(&timestamp, footer + RTC_REGISTER_COUNT * 8, 8);
 
-            LARGE_INTEGER liSize;
-            liSize.QuadPart = static_cast<LONGLONG>(ramBanks * ERAM_BANK_SIZE);
-            if (!SetFilePointerEx(hSavFile.get(), liSize, nullptr, FILE_BEGIN) ||
-                !SetEndOfFile(hSavFile.get())) {
-                std::cerr << "Erreur lors de la dfinition de la taille du fichier .sav." << std::endl;
-                return nullptr;
-            }
+    setRTCRegisters(Cart, regs, 0);
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    if (timestamp > 0 && now > timestamp && !Cart->MBC3.rtcHalted) {
+        Cart->MBC3.rtcCycles += static_cast<uint64_t>(now - timestamp) * CARTRIDGE_CLOCK_FREQ;
+    }
+    syncRTC(Cart);
+}
 
-            unique_handle hMap(CreateFileMappingA(
-                hSavFile.get(),
-                nullptr,
-                PAGE_READWRITE,
-                0,
-                0,
-                nullptr));
-
-            if (!hMap) {
-                std::cerr << "Erreur lors de la cration du mapping de fichier." << std::endl;
-                return nullptr;
-            }
+static void latchRTC(Cartridge* Cart) {
+    syncRTC(Cart);
+    getRTCRegisters(Cart, Cart->MBC3.latchedRTC);
+    writeRTCFooter(Cart);
+}
 
-            LPVOID mappedView = MapViewOfFile(
-                hMap.get(),
-                FILE_MAP_READ | FILE_MAP_WRITE,
-                0,
-                0,
-                ramBanks * ERAM_BANK_SIZE);
+static void writeRTCRegister(Cartridge* Cart, int reg, uint8_t Data) {
+    syncRTC(Cart);
+    uint8_t regs[RTC_REGISTER_COUNT];
+    getRTCRegisters(Cart, regs);
+    regs[reg] = Data & RTC_REGISTER_MASKS[reg];
+    setRTCRegisters(Cart, regs, reg == RTC_S ? 0 : Cart->MBC3.rtcCycles % CARTRIDGE_CLOCK_FREQ);
+    writeRTCFooter(Cart);
+}
 
-            if (!mappedView) {
-                std::cerr << "Erreur lors du mappage de la vue du fichier .sav." << std::endl;
-                return nullptr;
-            }
+std::string generateSAVFilename(const std::string& fileName) {
+    std::filesystem::path path(fileName);
+    return path.replace_extension(".sav").string();
+}
 
-            Cart->ram = reinterpret_cast<uint8_t(*)[ERAM_BANK_SIZE]>(mappedView);
+Cartridge* createCartridge(RomImage* image, const char* saveFileName)
+{
+    auto Cart = std::make_unique<Cartridge>();
+    Cart->Mapper = image->Mapper;
+    Cart->hasBatteryBackup = image->hasBatteryBackup;
+    Cart->romBanks = image->romBanks;
+    Cart->ramBanks = image->ramBanks;
+    Cart->hasRTC = image->hasRTC;
+
+    if (Cart->hasBatteryBackup && (Cart->ramBanks > 0 || Cart->hasRTC)) {
+        size_t saveSize = Cart->ramBanks * ERAM_BANK_SIZE + (Cart->hasRTC ? RTC_FOOTER_SIZE : 0);
+        Cart->save = openBatterySave(saveFileName, saveSize);
+        if (!Cart->save) {
+            return nullptr;
         }
-        else {
-
-            uint8_t(*ram)[ERAM_BANK_SIZE] = reinterpret_cast<uint8_t(*)[ERAM_BANK_SIZE]>(
-                std::calloc(ramBanks, ERAM_BANK_SIZE));
-            if (!ram) {
-                std::cerr << "chec de l'allocation de la mmoire RAM." << std::endl;
-                std::free(Cart->rom);
-                return nullptr;
-            }
-            Cart->ram = ram;
+        if (Cart->ramBanks > 0) {
+            Cart->ram = reinterpret_cast<uint8_t(*)[ERAM_BANK_SIZE]>(Cart->save->data);
+        }
+        if (Cart->hasRTC) {
+            readRTCFooter(Cart.get());
         }
     }
+    else if (Cart->ramBanks > 0) {
+        uint8_t(*ram)[ERAM_BANK_SIZE] = reinterpret_cast<uint8_t(*)[ERAM_BANK_SIZE]>(
+            std::calloc(Cart->ramBanks, ERAM_BANK_SIZE));
+        if (!ram) {
+            std::cerr << "chec de l'allocation de la mmoire RAM." << std::endl;
+            return nullptr;
+        }
+        Cart->ram = ram;
+    }
+
+    retainRomImage(image);
+    Cart->image = image;
+    Cart->rom = reinterpret_cast<uint8_t(*)[ROM_BANK_SIZE]>(const_cast<uint8_t*>(image->data));
 
     return Cart.release();
 
 }
 
+Cartridge* createCartridge(const char* fileName)
+{
+    RomImage* image = acquireRomImage(fileName);
+    if (!image) {
+        return nullptr;
+    }
+
+    Cartridge* Cart = createCartridge(image, generateSAVFilename(fileName).c_str());
+    releaseRomImage(image);
+    return Cart;
+}
+
 void destroyCartridge(Cartridge* Cart)
 {
     if (!Cart)
         return;
 
-    if (Cart->rom) {
-        std::free(Cart->rom);
-    }
-
-    if (Cart->ram) {
-        if (Cart->hasBatteryBackup) {
-            UnmapViewOfFile(Cart->ram);
-        }
-        else {
-            std::free(Cart->ram);
+    if (Cart->save) {
+        if (Cart->hasRTC) {
+            latchRTC(Cart);
         }
+        closeBatterySave(Cart->save);
+    }
+    else if (Cart->ram) {
+        std::free(Cart->ram);
     }
 
+    releaseRomImage(Cart->image);
     std::free(Cart);
 }
 
@@ -227,97 +189,52 @@ uint8_t readFromCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region)
 
     switch (Cart->Mapper) {
     case MBC::MBC0:
-        switch (Region) {
-        case CartRegion::ROM0:
-            return Cart->rom[0][Address];
-        case CartRegion::ROM1:
-            return Cart->rom[1][Address];
-        case CartRegion::RAM:
-            return (Cart->ramBanks > 0) ? Cart->ram[0][Address] : 0xFF;
-        }
-        break;
-
+        return readFromCartridge<MBC::MBC0>(Cart, Address, Region);
     case MBC::MBC1:
-        switch (Region) {
-        case CartRegion::ROM0:
-            if (Cart->MBC1.memoryMode == 0) {
-                return Cart->rom[0][Address];
-            }
-            else {
-                int bank = (Cart->MBC1.currentRomBank2 << 5) & (Cart->romBanks - 1);
-                bank = (Cart->romBanks > 32) ? bank : 0;
-                return Cart->rom[bank][Address];
-            }
-        case CartRegion::ROM1:
-        {
-            int bank = ((Cart->MBC1.currentRomBank5 ? Cart->MBC1.currentRomBank5 : 1) |
-                ((Cart->romBanks > 32) ? (Cart->MBC1.currentRomBank2 << 5) : 0)) &
-                (Cart->romBanks - 1);
-            return Cart->rom[bank][Address];
-        }
-        case CartRegion::RAM:
-            if (Cart->ramBanks > 0 && Cart->MBC1.isRamEnabled) {
-                int ram_bank = (Cart->MBC1.memoryMode == 0 || Cart->romBanks > 32)
-                    ? 0
-                    : (Cart->MBC1.currentRomBank2 & (Cart->ramBanks - 1));
-                return Cart->ram[ram_bank][Address];
-            }
-            return 0xFF;
-        }
-        break;
-
+        return readFromCartridge<MBC::MBC1>(Cart, Address, Region);
+    case MBC::MBC3:
+        return readFromCartridge<MBC::MBC3>(Cart, Address, Region);
     case MBC::MBC5:
-        switch (Region) {
-        case CartRegion::ROM0:
-            return Cart->rom[0][Address];
-        case CartRegion::ROM1:
-        {
-            int bank = Cart->MBC5.currentRomBank & (Cart->romBanks - 1);
-            return Cart->rom[bank][Address];
-        }
-        case CartRegion::RAM:
-            if (Cart->ramBanks > 0 && Cart->MBC5.isRamEnabled) {
-                int ram_bank = Cart->MBC5.cur_ram_bank & (Cart->ramBanks - 1);
-                return Cart->ram[ram_bank][Address];
-            }
-            return 0xFF;
-        }
-        break;
-
+        return readFromCartridge<MBC::MBC5>(Cart, Address, Region);
     default:
         return 0xFF;
     }
-
-    return 0xFF;
 }
 
+template <MBC Mapper>
 void writeToCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data)
 {
     if (!Cart)
         return;
 
-    switch (Cart->Mapper) {
-    case MBC::MBC0:
+    if constexpr (Mapper == MBC::MBC0) {
         if (Region == CartRegion::RAM && Cart->ramBanks > 0) {
             Cart->ram[0][Address] = Data;
+            if (Cart->save) {
+                markBatterySaveDirty(Cart->save, Address);
+            }
         }
-        break;
-
-    case MBC::MBC1:
+    }
+    else if constexpr (Mapper == MBC::MBC1) {
         switch (Region) {
         case CartRegion::ROM0:
             if (Address < 0x2000) {
                 if (Data == 0x0A || Data == 0x00) {
+                    if (Cart->save && Cart->MBC1.isRamEnabled && !Data) {
+                        requestBatterySaveFlush(Cart->save);
+                    }
                     Cart->MBC1.isRamEnabled = Data;
                 }
             }
             else {
                 Cart->MBC1.currentRomBank5 = Data & 0b00011111;
+                prefetchROMBank(Cart, getROM1Bank<Mapper>(Cart));
             }
             break;
         case CartRegion::ROM1:
             if (Address < 0x2000) {
                 Cart->MBC1.currentRomBank2 = Data & 0b00000011;
+                prefetchROMBank(Cart, getROM1Bank<Mapper>(Cart));
             }
             else {
                 if (Data == 0x01 || Data == 0x00) {
@@ -327,33 +244,36 @@ void writeToCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region, uint
             break;
         case CartRegion::RAM:
             if (Cart->ramBanks > 0 && Cart->MBC1.isRamEnabled) {
-                if (Cart->MBC1.memoryMode == 0 || Cart->romBanks > 32) {
-                    Cart->ram[0][Address] = Data;
-                }
-                else {
-                    int ram_bank = Cart->MBC1.currentRomBank2 & (Cart->ramBanks - 1);
-                    Cart->ram[ram_bank][Address] = Data;
+                int ram_bank = (Cart->MBC1.memoryMode == 0 || Cart->romBanks > 32)
+                    ? 0 : Cart->MBC1.currentRomBank2 & (Cart->ramBanks - 1);
+                Cart->ram[ram_bank][Address] = Data;
+                if (Cart->save) {
+                    markBatterySaveDirty(Cart->save, ram_bank * ERAM_BANK_SIZE);
                 }
             }
             break;
         }
-        break;
-
-    case MBC::MBC5:
+    }
+    else if constexpr (Mapper == MBC::MBC5) {
         switch (Region) {
         case CartRegion::ROM0:
             if (Address < 0x2000) {
                 if ((Data & 0x0F) == 0x0A || Data == 0x00) {
+                    if (Cart->save && Cart->MBC5.isRamEnabled && !Data) {
+                        requestBatterySaveFlush(Cart->save);
+                    }
                     Cart->MBC5.isRamEnabled = Data;
                 }
             }
             else {
                 Cart->MBC5.currentRomBankLow = Data;
+                prefetchROMBank(Cart, getROM1Bank<Mapper>(Cart));
             }
             break;
         case CartRegion::ROM1:
             if (Address < 0x2000) {
                 Cart->MBC5.currentRomBankHigh = Data & 0x01;
+                prefetchROMBank(Cart, getROM1Bank<Mapper>(Cart));
             }
             else {
                 Cart->MBC5.cur_ram_bank = Data;
@@ -363,13 +283,83 @@ void writeToCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region, uint
             if (Cart->ramBanks > 0 && Cart->MBC5.isRamEnabled) {
                 int ram_bank = Cart->MBC5.cur_ram_bank & (Cart->ramBanks - 1);
                 Cart->ram[ram_bank][Address] = Data;
+                if (Cart->save) {
+                    markBatterySaveDirty(Cart->save, ram_bank * ERAM_BANK_SIZE);
+                }
             }
             break;
         }
-        break;
+    }
+    else if constexpr (Mapper == MBC::MBC3) {
+        switch (Region) {
+        case CartRegion::ROM0:
+            if (Address < 0x2000) {
+                bool enabled = (Data & 0x0F) == 0x0A;
+                if (Cart->save && Cart->MBC3.isRamEnabled && !enabled) {
+                    requestBatterySaveFlush(Cart->save);
+                }
+                Cart->MBC3.isRamEnabled = enabled;
+            }
+            else {
+                Cart->MBC3.currentRomBank = Data & 0x7F;
+                prefetchROMBank(Cart, getROM1Bank<Mapper>(Cart));
+            }
+            break;
+        case CartRegion::ROM1:
+            if (Address < 0x2000) {
+                Cart->MBC3.cur_ram_bank = Data;
+            }
+            else {
+                if (Cart->hasRTC && Cart->MBC3.latchState == 0x00 && Data == 0x01) {
+                    latchRTC(Cart);
+                }
+                Cart->MBC3.latchState = Data;
+            }
+            break;
+        case CartRegion::RAM:
+            if (!Cart->MBC3.isRamEnabled) {
+                break;
+            }
+            if (Cart->MBC3.cur_ram_bank <= 0x03 && Cart->ramBanks > 0) {
+                int ram_bank = Cart->MBC3.cur_ram_bank & (Cart->ramBanks - 1);
+                Cart->ram[ram_bank][Address] = Data;
+                if (Cart->save) {
+                    markBatterySaveDirty(Cart->save, ram_bank * ERAM_BANK_SIZE);
+                }
+            }
+            else if (Cart->hasRTC && Cart->MBC3.cur_ram_bank >= 0x08 && Cart->MBC3.cur_ram_bank <= 0x0C) {
+                writeRTCRegister(Cart, Cart->MBC3.cur_ram_bank - 0x08, Data);
+            }
+            break;
+        }
+    }
+}
 
-    default:
+template void writeToCartridge<MBC::MBC0>(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data);
+template void writeToCartridge<MBC::MBC1>(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data);
+template void writeToCartridge<MBC::MBC2>(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data);
+template void writeToCartridge<MBC::MBC3>(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data);
+template void writeToCartridge<MBC::MBC5>(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data);
+
+void writeToCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data)
+{
+    if (!Cart)
+        return;
 
+    switch (Cart->Mapper) {
+    case MBC::MBC0:
+        writeToCartridge<MBC::MBC0>(Cart, Address, Region, Data);
+        break;
+    case MBC::MBC1:
+        writeToCartridge<MBC::MBC1>(Cart, Address, Region, Data);
+        break;
+    case MBC::MBC3:
+        writeToCartridge<MBC::MBC3>(Cart, Address, Region, Data);
+        break;
+    case MBC::MBC5:
+        writeToCartridge<MBC::MBC5>(Cart, Address, Region, Data);
+        break;
+    default:
         break;
     }
 }
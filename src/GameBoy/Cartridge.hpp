@@ -1,14 +1,31 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 constexpr uint16_t ROM_BANK_SIZE = 16 * 1024;
 constexpr uint16_t ERAM_BANK_SIZE = 8 * 1024;
+constexpr int MAX_ROM_BANKS = 512;
+
+constexpr uint32_t CARTRIDGE_CLOCK_FREQ = 4194304;
+constexpr int RTC_REGISTER_COUNT = 5;
+constexpr size_t RTC_FOOTER_SIZE = 48;
+
+struct BatterySave;
+struct RomImage;
 
 enum class MBC { MBC0, MBC1, MBC2, MBC3, MBC5 };
 
 enum class CartRegion { ROM0, ROM1, RAM };
 
+enum RTCRegisters { RTC_S, RTC_M, RTC_H, RTC_DL, RTC_DH };
+
+enum RTCFlags {
+    RTC_DAY_HIGH = 0x01,
+    RTC_HALT = 0x40,
+    RTC_CARRY = 0x80
+};
+
 struct Cartridge {
     MBC Mapper;
 
@@ -18,7 +35,13 @@ struct Cartridge {
     uint8_t(*rom)[ROM_BANK_SIZE];
     uint8_t(*ram)[ERAM_BANK_SIZE];
 
+    RomImage* image;
+
     bool hasBatteryBackup;
+    bool hasRTC;
+    BatterySave* save;
+
+    uint64_t clockCycles;
 
     union {
         struct {
@@ -39,12 +62,123 @@ struct Cartridge {
             };
             uint8_t cur_ram_bank;
         } MBC5;
+
+        struct {
+            bool isRamEnabled;
+            uint8_t currentRomBank;
+            uint8_t cur_ram_bank;
+            uint8_t latchState;
+            uint8_t latchedRTC[RTC_REGISTER_COUNT];
+            bool rtcHalted;
+            bool rtcCarry;
+            uint64_t rtcCycles;
+            uint64_t rtcSyncCycle;
+        } MBC3;
     };
 
 };
 
 Cartridge* createCartridge(const char* fileName);
+Cartridge* createCartridge(RomImage* image, const char* saveFileName);
 void destroyCartridge(Cartridge* Cart);
 
 uint8_t readFromCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region);
 void writeToCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data);
+
+template <MBC Mapper>
+inline int getROM1Bank(const Cartridge* Cart) {
+    if constexpr (Mapper == MBC::MBC1) {
+        return ((Cart->MBC1.currentRomBank5 ? Cart->MBC1.currentRomBank5 : 1) |
+            ((Cart->romBanks > 32) ? (Cart->MBC1.currentRomBank2 << 5) : 0)) &
+            (Cart->romBanks - 1);
+    }
+    else if constexpr (Mapper == MBC::MBC3) {
+        return (Cart->MBC3.currentRomBank ? Cart->MBC3.currentRomBank : 1) & (Cart->romBanks - 1);
+    }
+    else if constexpr (Mapper == MBC::MBC5) {
+        return Cart->MBC5.currentRomBank & (Cart->romBanks - 1);
+    }
+    else {
+        return 1;
+    }
+}
+
+template <MBC Mapper>
+inline uint8_t readFromCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region)
+{
+    if (!Cart)
+        return 0xFF;
+
+    if constexpr (Mapper == MBC::MBC0) {
+        switch (Region) {
+        case CartRegion::ROM0:
+            return Cart->rom[0][Address];
+        case CartRegion::ROM1:
+            return Cart->rom[1][Address];
+        case CartRegion::RAM:
+            return (Cart->ramBanks > 0) ? Cart->ram[0][Address] : 0xFF;
+        }
+    }
+    else if constexpr (Mapper == MBC::MBC1) {
+        switch (Region) {
+        case CartRegion::ROM0:
+            if (Cart->MBC1.memoryMode == 0) {
+                return Cart->rom[0][Address];
+            }
+            else {
+                int bank = (Cart->MBC1.currentRomBank2 << 5) & (Cart->romBanks - 1);
+                bank = (Cart->romBanks > 32) ? bank : 0;
+                return Cart->rom[bank][Address];
+            }
+        case CartRegion::ROM1:
+            return Cart->rom[getROM1Bank<Mapper>(Cart)][Address];
+        case CartRegion::RAM:
+            if (Cart->ramBanks > 0 && Cart->MBC1.isRamEnabled) {
+                int ram_bank = (Cart->MBC1.memoryMode == 0 || Cart->romBanks > 32)
+                    ? 0
+                    : (Cart->MBC1.currentRomBank2 & (Cart->ramBanks - 1));
+                return Cart->ram[ram_bank][Address];
+            }
+            return 0xFF;
+        }
+    }
+    else if constexpr (Mapper == MBC::MBC5) {
+        switch (Region) {
+        case CartRegion::ROM0:
+            return Cart->rom[0][Address];
+        case CartRegion::ROM1:
+            return Cart->rom[getROM1Bank<Mapper>(Cart)][Address];
+        case CartRegion::RAM:
+            if (Cart->ramBanks > 0 && Cart->MBC5.isRamEnabled) {
+                int ram_bank = Cart->MBC5.cur_ram_bank & (Cart->ramBanks - 1);
+                return Cart->ram[ram_bank][Address];
+            }
+            return 0xFF;
+        }
+    }
+    else if constexpr (Mapper == MBC::MBC3) {
+        switch (Region) {
+        case CartRegion::ROM0:
+            return Cart->rom[0][Address];
+        case CartRegion::ROM1:
+            return Cart->rom[getROM1Bank<Mapper>(Cart)][Address];
+        case CartRegion::RAM:
+            if (!Cart->MBC3.isRamEnabled) {
+                return 0xFF;
+            }
+            if (Cart->MBC3.cur_ram_bank <= 0x03 && Cart->ramBanks > 0) {
+                int ram_bank = Cart->MBC3.cur_ram_bank & (Cart->ramBanks - 1);
+                return Cart->ram[ram_bank][Address];
+            }
+            if (Cart->hasRTC && Cart->MBC3.cur_ram_bank >= 0x08 && Cart->MBC3.cur_ram_bank <= 0x0C) {
+                return Cart->MBC3.latchedRTC[Cart->MBC3.cur_ram_bank - 0x08];
+            }
+            return 0xFF;
+        }
+    }
+
+    return 0xFF;
+}
+
+template <MBC Mapper>
+void writeToCartridge(Cartridge* Cart, uint16_t Address, CartRegion Region, uint8_t Data);
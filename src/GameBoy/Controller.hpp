@@ -2,4 +2,6 @@
 
 #include "SDLUtils.hpp"
 
+constexpr int CONTROLLER_TRIGGER_DEADZONE = 4096;
+
 SDLControllerPtr InitializeController();
@@ -7,7 +7,7 @@ std::string OpenFileDialog() {
     OPENFILENAMEW ofn;
     wchar_t szFileName[MAX_PATH] = L"";
 
-    wchar_t szFilter[] = L"Rom GameBoy (*.gb)\0*.gb\0Tout les fichiers (*.*)\0*.*\0\0";
+    wchar_t szFilter[] = L"Rom GameBoy (*.gb)\0*.gb\0Musique GameBoy (*.gbs)\0*.gbs\0Journal audio (*.apulog)\0*.apulog\0Tout les fichiers (*.*)\0*.*\0\0";
 
     ZeroMemory(&ofn, sizeof(ofn));
     ofn.lStructSize = sizeof(ofn);
@@ -0,0 +1,48 @@
+#include "FramePacer.hpp"
+
+#include <cmath>
+#include <thread>
+
+void initFramePacer(FramePacer* pacer, int refreshRate) {
+    pacer->vsyncLocked = refreshRate > 0 &&
+        std::abs(refreshRate - GAMEBOY_FRAME_RATE) <= GAMEBOY_FRAME_RATE * FRAME_PACER_LOCK_TOLERANCE;
+    pacer->frameRate = pacer->vsyncLocked ? refreshRate : GAMEBOY_FRAME_RATE;
+    pacer->nextDeadline = std::chrono::steady_clock::now();
+}
+
+void signalVSync(FramePacer* pacer) {
+    {
+        std::lock_guard<std::mutex> lock(pacer->mutex);
+        pacer->vsyncCount++;
+    }
+    pacer->vsyncCondition.notify_one();
+}
+
+void setFramePacerSpeed(FramePacer* pacer, double speed) {
+    pacer->speed = speed;
+}
+
+void waitForNextFrame(FramePacer* pacer) {
+    bool followVSync = pacer->vsyncLocked && pacer->speed == 1.0;
+    double frameRate = followVSync ? pacer->frameRate : GAMEBOY_FRAME_RATE * pacer->speed;
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / frameRate));
+
+    if (followVSync) {
+        std::unique_lock<std::mutex> lock(pacer->mutex);
+        pacer->vsyncCondition.wait_for(lock, 2 * period, [pacer]() { return pacer->vsyncCount > pacer->lastVsync; });
+        pacer->lastVsync = pacer->vsyncCount;
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    pacer->nextDeadline += period;
+    if (pacer->nextDeadline < now - period) {
+        pacer->nextDeadline = now;
+    }
+    std::this_thread::sleep_until(pacer->nextDeadline);
+}
+
+double getFrameRateRatio(const FramePacer* pacer) {
+    return pacer->vsyncLocked && pacer->speed == 1.0 ? GAMEBOY_FRAME_RATE / pacer->frameRate : 1.0;
+}
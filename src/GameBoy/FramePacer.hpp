@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+constexpr double GAMEBOY_FRAME_RATE = 4194304.0 / 70224.0;
+constexpr double FRAME_PACER_LOCK_TOLERANCE = 0.01;
+
+struct FramePacer {
+    std::atomic<bool> enabled = true;
+    bool vsyncLocked = false;
+    double frameRate = GAMEBOY_FRAME_RATE;
+    double speed = 1.0;
+
+    std::mutex mutex;
+    std::condition_variable vsyncCondition;
+    uint64_t vsyncCount = 0;
+
+    uint64_t lastVsync = 0;
+    std::chrono::steady_clock::time_point nextDeadline;
+};
+
+void initFramePacer(FramePacer* pacer, int refreshRate);
+void signalVSync(FramePacer* pacer);
+void setFramePacerSpeed(FramePacer* pacer, double speed);
+void waitForNextFrame(FramePacer* pacer);
+double getFrameRateRatio(const FramePacer* pacer);
@@ -0,0 +1,20 @@
+#include "FrameQueue.hpp"
+
+uint32_t* getWriteFrame(FrameQueue* queue) {
+    return queue->buffers[queue->writeIndex].data();
+}
+
+uint32_t* publishFrame(FrameQueue* queue) {
+    uint8_t previous = queue->pendingIndex.exchange(queue->writeIndex | FRAME_FRESH_BIT, std::memory_order_acq_rel);
+    queue->writeIndex = previous & FRAME_INDEX_MASK;
+    return getWriteFrame(queue);
+}
+
+const uint32_t* acquireLatestFrame(FrameQueue* queue) {
+    if (!(queue->pendingIndex.load(std::memory_order_relaxed) & FRAME_FRESH_BIT)) {
+        return nullptr;
+    }
+    uint8_t previous = queue->pendingIndex.exchange(queue->readIndex, std::memory_order_acq_rel);
+    queue->readIndex = previous & FRAME_INDEX_MASK;
+    return queue->buffers[queue->readIndex].data();
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "PPU.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+constexpr uint8_t FRAME_INDEX_MASK = 0b011;
+constexpr uint8_t FRAME_FRESH_BIT = 0b100;
+
+using FrameBuffer = std::array<uint32_t, SCREEN_WIDTH * SCREEN_HEIGHT>;
+
+struct FrameQueue {
+    std::array<FrameBuffer, 3> buffers{};
+
+    std::atomic<uint8_t> pendingIndex{ 1 };
+    uint8_t writeIndex = 0;
+    uint8_t readIndex = 2;
+};
+
+uint32_t* getWriteFrame(FrameQueue* queue);
+uint32_t* publishFrame(FrameQueue* queue);
+const uint32_t* acquireLatestFrame(FrameQueue* queue);
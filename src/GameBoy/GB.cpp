@@ -8,6 +8,7 @@
 #include "Cartridge.hpp"
 #include "GB.hpp"
 
+template <MBC Mapper>
 uint8_t readMemoryByte(GameBoy* bus, uint16_t addr) {
     bus->CPU.currentCycles += 4;
 
@@ -16,10 +17,10 @@ uint8_t readMemoryByte(GameBoy* bus, uint16_t addr) {
     }
 
     if (addr >= 0x0000 && addr <= 0x3FFF) {
-        return readFromCartridge(bus->cart, addr, CartRegion::ROM0);
+        return readFromCartridge<Mapper>(bus->cart, addr, CartRegion::ROM0);
     }
     else if (addr >= 0x4000 && addr <= 0x7FFF) {
-        return readFromCartridge(bus->cart, addr & 0x3FFF, CartRegion::ROM1);
+        return readFromCartridge<Mapper>(bus->cart, addr & 0x3FFF, CartRegion::ROM1);
     }
     else if (addr >= 0x8000 && addr <= 0x9FFF) {
         if (!(bus->io[LCDC] & LCDC_DISPLAY_ENABLE) ||
@@ -29,7 +30,7 @@ uint8_t readMemoryByte(GameBoy* bus, uint16_t addr) {
         return 0xFF;
     }
     else if (addr >= 0xA000 && addr <= 0xBFFF) {
-        return readFromCartridge(bus->cart, addr & 0x1FFF, CartRegion::RAM);
+        return readFromCartridge<Mapper>(bus->cart, addr & 0x1FFF, CartRegion::RAM);
     }
     else if (addr >= 0xC000 && addr <= 0xCFFF) {
         return bus->wram[0][addr & 0x0FFF];
@@ -55,6 +56,9 @@ uint8_t readMemoryByte(GameBoy* bus, uint16_t addr) {
         return 0xFF;
     }
     else if (addr >= 0xFF00 && addr <= 0xFF7F) {
+        if (addr >= 0xFF10 && addr <= 0xFF3F) {
+            syncAPU(&bus->apu);
+        }
         if (addr == 0xFF04) {
             return (bus->div >> 8) & 0xFF;
         }
@@ -73,27 +77,45 @@ uint8_t readMemoryByte(GameBoy* bus, uint16_t addr) {
     return 0xFF;
 }
 
+void forwardPPUWrite(GameBoy* gb, uint16_t addr, uint8_t data) {
+    if (gb->ppuThread) logPPUWrite(gb->ppuThread, addr, data);
+    if (gb->ppuDeferred) logDeferredPPUWrite(gb->ppuDeferred, addr, data);
+}
+
+static void syncCartridgeClock(GameBoy* bus) {
+    if (bus->cart && bus->cart->hasRTC) {
+        bus->cart->clockCycles = bus->apu.elapsedCycles + bus->apu.pendingCycles;
+    }
+}
+
+template <MBC Mapper>
 void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data) {
     bus->CPU.currentCycles += 4;
 
     if (bus->dma_active && addr < 0xff00) return;
+    if (addr < 0x8000) {
+        syncCartridgeClock(bus);
+    }
     if (addr < 0x4000) {
-        writeToCartridge(bus->cart, addr, CartRegion::ROM0, data);
+        writeToCartridge<Mapper>(bus->cart, addr, CartRegion::ROM0, data);
         return;
     }
     if (addr < 0x8000) {
-        writeToCartridge(bus->cart, addr & 0x3fff, CartRegion::ROM1, data);
+        writeToCartridge<Mapper>(bus->cart, addr & 0x3fff, CartRegion::ROM1, data);
         return;
     }
     if (addr < 0xa000) {
         if (!(bus->io[LCDC] & LCDC_DISPLAY_ENABLE) ||
             (bus->io[STAT] & STAT_MODE) != 3) {
             bus->vram[0][addr & 0x1fff] = data;
+            notifyPPUVRAMWrite(&bus->ppu, addr & 0x1fff);
+            forwardPPUWrite(bus, addr, data);
         }
         return;
     }
     if (addr < 0xc000) {
-        writeToCartridge(bus->cart, addr & 0x1fff, CartRegion::RAM, data);
+        syncCartridgeClock(bus);
+        writeToCartridge<Mapper>(bus->cart, addr & 0x1fff, CartRegion::RAM, data);
         return;
     }
     if (addr < 0xd000) {
@@ -111,6 +133,7 @@ void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data) {
     if (addr < 0xfea0) {
         if (!(bus->io[LCDC] & LCDC_DISPLAY_ENABLE) || (bus->io[STAT] & STAT_MODE) < 2) {
             bus->oam[addr - 0xfe00] = data;
+            forwardPPUWrite(bus, addr, data);
         }
         return;
     }
@@ -118,6 +141,11 @@ void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data) {
         return;
     }
     if (addr < 0xff80) {
+        if (addr >= 0xff10 && addr < 0xff40) {
+            notifyAPURegisterWrite(&bus->apu);
+            if (bus->apuLog) logAPUWrite(bus->apuLog, bus->apu.elapsedCycles, addr, data);
+            if (bus->apuThread) logAPUThreadWrite(bus->apuThread, bus->apu.elapsedCycles, addr, data);
+        }
         if (!bus->apu.CH3.enable && (addr & 0x00f0) == WAVERAM) {
             (bus->io + WAVERAM)[addr & 0x000f] = data;
             return;
@@ -127,6 +155,9 @@ void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data) {
             bus->io[JOYP] = (bus->io[JOYP] & 0b11001111) | (data & 0b00110000);
             break;
         case DIV:
+            notifyAPURegisterWrite(&bus->apu);
+            if (bus->apuLog) logAPUWrite(bus->apuLog, bus->apu.elapsedCycles, addr, data);
+            if (bus->apuThread) logAPUThreadWrite(bus->apuThread, bus->apu.elapsedCycles, addr, data);
             bus->div = 0x0000;
             break;
         case TIMA:
@@ -258,39 +289,57 @@ void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data) {
             bus->io[NR52] = data & static_cast<uint8_t>(APUConstants::NR52::APU_ENABLE_BIT);
             break;
         case LCDC:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[LCDC] = data;
+            forwardPPUWrite(bus, addr, data);
             break;
         case STAT:
             bus->io[STAT] = (bus->io[STAT] & 0b000111) | (data & 0b01111000);
             break;
         case SCY:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[SCY] = data;
+            forwardPPUWrite(bus, addr, data);
             break;
         case SCX:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[SCX] = data;
+            forwardPPUWrite(bus, addr, data);
             break;
         case LYC:
             bus->io[LYC] = data;
             break;
         case DMA:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[DMA] = data;
             bus->dma_active = true;
             bus->dma_index = 0;
+            forwardPPUWrite(bus, PPU_LOG_DMA_STATE, 1);
             break;
         case BGP:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[BGP] = data;
+            forwardPPUWrite(bus, addr, data);
             break;
         case OBP0:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[OBP0] = data;
+            forwardPPUWrite(bus, addr, data);
             break;
         case OBP1:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[OBP1] = data;
+            forwardPPUWrite(bus, addr, data);
             break;
         case WY:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[WY] = data;
+            forwardPPUWrite(bus, addr, data);
             break;
         case WX:
+            notifyPPURegisterWrite(&bus->ppu);
             bus->io[WX] = data;
+            forwardPPUWrite(bus, addr, data);
             break;
         }
 
@@ -302,23 +351,126 @@ void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data) {
     if (addr == 0xffff) bus->IE = data & 0b00011111;
 }
 
+template <MBC Mapper>
 uint16_t readMemoryWord(GameBoy* bus, uint16_t addr) {
-    return readMemoryByte(bus, addr) | ((uint16_t)readMemoryByte(bus, addr + 1) << 8);
+    return readMemoryByte<Mapper>(bus, addr) | ((uint16_t)readMemoryByte<Mapper>(bus, addr + 1) << 8);
 }
 
+template <MBC Mapper>
 void writeMemoryWord(GameBoy* bus, uint16_t addr, uint16_t data) {
-    writeMemoryByte(bus, addr, static_cast<uint8_t>(data));
-    writeMemoryByte(bus, addr + 1, static_cast<uint8_t>(data >> 8));
+    writeMemoryByte<Mapper>(bus, addr, static_cast<uint8_t>(data));
+    writeMemoryByte<Mapper>(bus, addr + 1, static_cast<uint8_t>(data >> 8));
 }
 
+template <MBC Mapper>
 void emulateCycle(struct GameBoy* gb) {
     checkStatusInterrupt(gb);
     updateTimers(gb);
     updateJoypadState(gb);
     if (gb->dma_active) executeDMA(gb);
-    PPUClock(&gb->ppu);
-    APUClock(&gb->apu);
-    CPUClock(&gb->CPU);
+    if (gb->ppuThread) {
+        PPUTimingClock(&gb->ppu);
+        advancePPUThread(gb->ppuThread, gb->ppu.currentCycle == 0);
+    }
+    else if (gb->ppuDeferred) {
+        PPUTimingClock(&gb->ppu);
+        advanceDeferredPPU(gb->ppuDeferred);
+    }
+    else {
+        PPUClock(&gb->ppu);
+    }
+    if (++gb->apu.pendingCycles >= gb->apu.cyclesUntilEvent) {
+        syncAPU(&gb->apu);
+        if (gb->apuThread) advanceAPUThread(gb->apuThread, gb->apu.elapsedCycles);
+    }
+    CPUClock<Mapper>(&gb->CPU);
+}
+
+template uint8_t readMemoryByte<MBC::MBC0>(GameBoy* bus, uint16_t addr);
+template uint8_t readMemoryByte<MBC::MBC1>(GameBoy* bus, uint16_t addr);
+template uint8_t readMemoryByte<MBC::MBC2>(GameBoy* bus, uint16_t addr);
+template uint8_t readMemoryByte<MBC::MBC3>(GameBoy* bus, uint16_t addr);
+template uint8_t readMemoryByte<MBC::MBC5>(GameBoy* bus, uint16_t addr);
+
+template uint16_t readMemoryWord<MBC::MBC0>(GameBoy* bus, uint16_t addr);
+template uint16_t readMemoryWord<MBC::MBC1>(GameBoy* bus, uint16_t addr);
+template uint16_t readMemoryWord<MBC::MBC2>(GameBoy* bus, uint16_t addr);
+template uint16_t readMemoryWord<MBC::MBC3>(GameBoy* bus, uint16_t addr);
+template uint16_t readMemoryWord<MBC::MBC5>(GameBoy* bus, uint16_t addr);
+
+template void writeMemoryByte<MBC::MBC0>(GameBoy* bus, uint16_t addr, uint8_t data);
+template void writeMemoryByte<MBC::MBC1>(GameBoy* bus, uint16_t addr, uint8_t data);
+template void writeMemoryByte<MBC::MBC2>(GameBoy* bus, uint16_t addr, uint8_t data);
+template void writeMemoryByte<MBC::MBC3>(GameBoy* bus, uint16_t addr, uint8_t data);
+template void writeMemoryByte<MBC::MBC5>(GameBoy* bus, uint16_t addr, uint8_t data);
+
+template void writeMemoryWord<MBC::MBC0>(GameBoy* bus, uint16_t addr, uint16_t data);
+template void writeMemoryWord<MBC::MBC1>(GameBoy* bus, uint16_t addr, uint16_t data);
+template void writeMemoryWord<MBC::MBC2>(GameBoy* bus, uint16_t addr, uint16_t data);
+template void writeMemoryWord<MBC::MBC3>(GameBoy* bus, uint16_t addr, uint16_t data);
+template void writeMemoryWord<MBC::MBC5>(GameBoy* bus, uint16_t addr, uint16_t data);
+
+EmulateCycleFunction getEmulateCycleFunction(const Cartridge* cart) {
+    switch (cart ? cart->Mapper : MBC::MBC0) {
+    case MBC::MBC1:
+        return &emulateCycle<MBC::MBC1>;
+    case MBC::MBC2:
+        return &emulateCycle<MBC::MBC2>;
+    case MBC::MBC3:
+        return &emulateCycle<MBC::MBC3>;
+    case MBC::MBC5:
+        return &emulateCycle<MBC::MBC5>;
+    default:
+        return &emulateCycle<MBC::MBC0>;
+    }
+}
+
+uint8_t readMemoryByte(GameBoy* bus, uint16_t addr) {
+    switch (bus->cart ? bus->cart->Mapper : MBC::MBC0) {
+    case MBC::MBC1:
+        return readMemoryByte<MBC::MBC1>(bus, addr);
+    case MBC::MBC2:
+        return readMemoryByte<MBC::MBC2>(bus, addr);
+    case MBC::MBC3:
+        return readMemoryByte<MBC::MBC3>(bus, addr);
+    case MBC::MBC5:
+        return readMemoryByte<MBC::MBC5>(bus, addr);
+    default:
+        return readMemoryByte<MBC::MBC0>(bus, addr);
+    }
+}
+
+uint16_t readMemoryWord(GameBoy* bus, uint16_t addr) {
+    return readMemoryByte(bus, addr) | ((uint16_t)readMemoryByte(bus, addr + 1) << 8);
+}
+
+void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data) {
+    switch (bus->cart ? bus->cart->Mapper : MBC::MBC0) {
+    case MBC::MBC1:
+        writeMemoryByte<MBC::MBC1>(bus, addr, data);
+        break;
+    case MBC::MBC2:
+        writeMemoryByte<MBC::MBC2>(bus, addr, data);
+        break;
+    case MBC::MBC3:
+        writeMemoryByte<MBC::MBC3>(bus, addr, data);
+        break;
+    case MBC::MBC5:
+        writeMemoryByte<MBC::MBC5>(bus, addr, data);
+        break;
+    default:
+        writeMemoryByte<MBC::MBC0>(bus, addr, data);
+        break;
+    }
+}
+
+void writeMemoryWord(GameBoy* bus, uint16_t addr, uint16_t data) {
+    writeMemoryByte(bus, addr, static_cast<uint8_t>(data));
+    writeMemoryByte(bus, addr + 1, static_cast<uint8_t>(data >> 8));
+}
+
+void emulateCycle(struct GameBoy* gb) {
+    getEmulateCycleFunction(gb->cart)(gb);
 }
 
 void checkStatusInterrupt(struct GameBoy* gb) {
@@ -360,10 +512,10 @@ void updateTimers(GameBoy* gb_system) {
 void updateJoypadState(struct GameBoy* gb) {
     uint8_t buttons = 0b11110000;
     if (!(gb->io[JOYP] & JOYPAD_DIRECTIONAL)) {
-        buttons |= gb->jp_dir;
+        buttons |= gb->jp_dir.load(std::memory_order_relaxed);
     }
     if (!(gb->io[JOYP] & JOYPAD_ACTION)) {
-        buttons |= gb->jp_action;
+        buttons |= gb->jp_action.load(std::memory_order_relaxed);
     }
     buttons = ~buttons;
     if (buttons < (gb->io[JOYP] & 0b1111)) {
@@ -375,7 +527,9 @@ void updateJoypadState(struct GameBoy* gb) {
 void executeDMA(struct GameBoy* gb) {
     if (gb->dma_currentCycles == 0) {
         if (gb->dma_index == OAM_SIZE) {
+            notifyPPURegisterWrite(&gb->ppu);
             gb->dma_active = false;
+            forwardPPUWrite(gb, PPU_LOG_DMA_STATE, 0);
             return;
         }
         gb->dma_currentCycles += 4;
@@ -403,6 +557,7 @@ void executeDMA(struct GameBoy* gb) {
             data = 0xff;
         }
         gb->oam[gb->dma_index] = data;
+        forwardPPUWrite(gb, 0xFE00 | gb->dma_index, data);
         gb->dma_index++;
     }
     gb->dma_currentCycles--;
@@ -414,6 +569,7 @@ void resetGameBoy(struct GameBoy* gb, struct Cartridge* cart) {
     gb->ppu.GB = gb;
 
     gb->apu.GB = std::shared_ptr<GameBoy>(gb);
+    resetAPU(&gb->apu);
 
     gb->cart = cart;
     gb->CPU.A = 0x01;
@@ -422,47 +578,6 @@ void resetGameBoy(struct GameBoy* gb, struct Cartridge* cart) {
     gb->io[LCDC] |= LCDC_DISPLAY_ENABLE;
 }
 
-std::string generateScreenshotFilename() {
-    std::time_t t = std::time(nullptr);
-    std::tm tm;
-    localtime_s(&tm, &t);
-    char buffer[100];
-    std::strftime(buffer, sizeof(buffer), "ScreenShot_%d-%m-%Y_%H-%M-%S.bmp", &tm);
-    return std::string(buffer);
-}
-
-bool captureScreenshot(const GameBoy* gb_instance, const std::string& filename) {
-    if (!gb_instance->renderer) {
-        std::cerr << "Renderer non initialis!" << std::endl;
-        return false;
-    }
-
-    int width, height;
-    SDL_GetRendererOutputSize(gb_instance->renderer, &width, &height);
-
-    SDL_Surface* screen_surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
-    if (!screen_surface) {
-        std::cerr << "Erreur lors de la cration de la surface: " << SDL_GetError() << std::endl;
-        return false;
-    }
-
-    if (SDL_RenderReadPixels(gb_instance->renderer, NULL, SDL_PIXELFORMAT_ARGB8888, screen_surface->pixels, screen_surface->pitch) != 0) {
-        std::cerr << "Erreur lors de la lecture des pixels: " << SDL_GetError() << std::endl;
-        SDL_FreeSurface(screen_surface);
-        return false;
-    }
-
-    if (SDL_SaveBMP(screen_surface, filename.c_str()) != 0) {
-        std::cerr << "Erreur lors de la sauvegarde de l'image: " << SDL_GetError() << std::endl;
-        SDL_FreeSurface(screen_surface);
-        return false;
-    }
-
-    std::cout << "Capture d'cran effectue -> " << filename << std::endl;
-    SDL_FreeSurface(screen_surface);
-    return true;
-}
-
 void handleGameBoyEvent(struct GameBoy* gb, SDL_Event* e) {
 
     if (e->type != SDL_CONTROLLERBUTTONDOWN && e->type != SDL_CONTROLLERBUTTONUP) {
@@ -471,12 +586,12 @@ void handleGameBoyEvent(struct GameBoy* gb, SDL_Event* e) {
 
     bool pressed = (e->type == SDL_CONTROLLERBUTTONDOWN);
 
-    auto setFlag = [&](uint8_t& field, uint8_t flag) {
+    auto setFlag = [&](std::atomic<uint8_t>& field, uint8_t flag) {
         if (pressed) {
-            field |= flag;
+            field.fetch_or(flag, std::memory_order_relaxed);
         }
         else {
-            field &= ~flag;
+            field.fetch_and(static_cast<uint8_t>(~flag), std::memory_order_relaxed);
         }
         };
 
@@ -507,14 +622,6 @@ void handleGameBoyEvent(struct GameBoy* gb, SDL_Event* e) {
     case SDL_CONTROLLER_BUTTON_START:
         setFlag(gb->jp_action, JOYPAD_DOWN_START);
         break;
-    case SDL_CONTROLLER_BUTTON_MISC1:
-        if (pressed) {
-            std::string filename = generateScreenshotFilename();
-            if (!captureScreenshot(gb, filename)) {
-                std::cerr << "chec de la capture d'cran." << std::endl;
-            }
-        }
-        break;
 
     default:
         break;
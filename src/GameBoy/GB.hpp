@@ -1,11 +1,16 @@
 #pragma once
 
 #include "APU.hpp"
+#include "APULog.hpp"
+#include "APUThread.hpp"
 #include "Cartridge.hpp"
 #include "LocaleInitializer.hpp"
 #include "SM83.hpp"
 #include "PPU.hpp"
+#include "PPUDeferred.hpp"
+#include "PPUThread.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
@@ -81,8 +86,6 @@ enum {
 };
 
 struct GameBoy {
-    SDL_Renderer* renderer;
-
     SM83 CPU;
     GameBoyPPU ppu;
     GameBoyAPU apu;
@@ -107,20 +110,32 @@ struct GameBoy {
 
     bool prev_stat_int;
 
-    uint8_t jp_dir;
-    uint8_t jp_action;
+    std::atomic<uint8_t> jp_dir;
+    std::atomic<uint8_t> jp_action;
 
     bool dma_active;
     uint8_t dma_index;
     int dma_currentCycles;
 
+    PPUThread* ppuThread;
+    PPUDeferred* ppuDeferred;
+    APULog* apuLog;
+    APUThread* apuThread;
 };
 
+using EmulateCycleFunction = void (*)(GameBoy*);
+
 uint8_t readMemoryByte(GameBoy* bus, uint16_t addr);
 uint16_t readMemoryWord(GameBoy* bus, uint16_t addr);
 void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data);
 void writeMemoryWord(GameBoy* bus, uint16_t addr, uint16_t data);
 
+template <MBC Mapper> uint8_t readMemoryByte(GameBoy* bus, uint16_t addr);
+template <MBC Mapper> uint16_t readMemoryWord(GameBoy* bus, uint16_t addr);
+template <MBC Mapper> void writeMemoryByte(GameBoy* bus, uint16_t addr, uint8_t data);
+template <MBC Mapper> void writeMemoryWord(GameBoy* bus, uint16_t addr, uint16_t data);
+void forwardPPUWrite(GameBoy* gb, uint16_t addr, uint8_t data);
+
 void handleGameBoyEvent(struct GameBoy* gb, SDL_Event* e);
 
 void checkStatusInterrupt(struct GameBoy* gb);
@@ -129,5 +144,6 @@ void updateJoypadState(struct GameBoy* gb);
 void executeDMA(struct GameBoy* gb);
 
 void emulateCycle(struct GameBoy* gb);
+EmulateCycleFunction getEmulateCycleFunction(const Cartridge* cart);
 
 void resetGameBoy(struct GameBoy* gb, struct Cartridge* cart);
\ No newline at end of file
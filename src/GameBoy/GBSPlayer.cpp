@@ -0,0 +1,336 @@
+#include "GBSPlayer.hpp"
+
+#include "APU.hpp"
+#include "Cartridge.hpp"
+#include "GB.hpp"
+#include "Recorder.hpp"
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+constexpr uint64_t GBS_HASH_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t GBS_HASH_PRIME = 0x100000001b3ull;
+constexpr uint32_t GBS_TIMER_PERIODS[] = { 1024, 16, 64, 256 };
+constexpr int GBS_MAX_ROM_BANKS = 512;
+
+constexpr uint8_t GBS_OPCODE_JP = 0xC3;
+constexpr uint8_t GBS_OPCODE_RETI = 0xD9;
+constexpr uint8_t GBS_OPCODE_HALT = 0x76;
+constexpr uint8_t GBS_OPCODE_JR = 0x18;
+
+struct GBSPlayer {
+    GameBoy* gb;
+    Cartridge cart;
+    std::vector<uint8_t> ram;
+    uint16_t playAddress;
+    bool timerDriven;
+    bool pendingTick;
+    uint32_t frameCycles;
+
+    std::ofstream wav;
+    uint64_t hash;
+    uint64_t frames;
+};
+
+static uint16_t readLE16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static std::string readHeaderString(const uint8_t* data) {
+    const char* text = reinterpret_cast<const char*>(data);
+    return std::string(text, std::find(text, text + 32, '\0'));
+}
+
+bool isGBSFile(const std::string& fileName) {
+    std::string extension = std::filesystem::path(fileName).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".gbs";
+}
+
+bool loadGBSFile(GBSFile* gbs, const char* fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Impossible d'ouvrir le fichier: " << fileName << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < GBS_HEADER_SIZE || std::memcmp(data.data(), "GBS", 3) != 0) {
+        std::cerr << "Fichier GBS invalide: " << fileName << std::endl;
+        return false;
+    }
+
+    GBSHeader& header = gbs->header;
+    header.version = data[0x03];
+    header.songCount = data[0x04];
+    header.firstSong = data[0x05];
+    header.loadAddress = readLE16(&data[0x06]);
+    header.initAddress = readLE16(&data[0x08]);
+    header.playAddress = readLE16(&data[0x0A]);
+    header.stackPointer = readLE16(&data[0x0C]);
+    header.timerModulo = data[0x0E];
+    header.timerControl = data[0x0F];
+    header.title = readHeaderString(&data[0x10]);
+    header.author = readHeaderString(&data[0x30]);
+    header.copyright = readHeaderString(&data[0x50]);
+
+    if (header.songCount == 0 || header.loadAddress < GBS_MIN_LOAD_ADDRESS || header.loadAddress >= 0x8000) {
+        std::cerr << "En-tte GBS invalide: " << fileName << std::endl;
+        return false;
+    }
+
+    size_t payloadSize = data.size() - GBS_HEADER_SIZE;
+    size_t imageSize = header.loadAddress + payloadSize;
+    int romBanks = 2;
+    while (static_cast<size_t>(romBanks) * ROM_BANK_SIZE < imageSize) {
+        romBanks *= 2;
+    }
+    if (romBanks > GBS_MAX_ROM_BANKS) {
+        std::cerr << "Nombre de banques ROM invalide: " << romBanks << std::endl;
+        return false;
+    }
+
+    gbs->romBanks = romBanks;
+    gbs->image.assign(static_cast<size_t>(romBanks) * ROM_BANK_SIZE, 0x00);
+    for (uint16_t vector = 0x00; vector < 0x40; vector += 8) {
+        uint16_t target = header.loadAddress + vector;
+        gbs->image[vector] = GBS_OPCODE_JP;
+        gbs->image[vector + 1] = static_cast<uint8_t>(target);
+        gbs->image[vector + 2] = static_cast<uint8_t>(target >> 8);
+    }
+    for (uint16_t vector = 0x40; vector <= 0x60; vector += 8) {
+        gbs->image[vector] = GBS_OPCODE_RETI;
+    }
+    gbs->image[GBS_IDLE_ADDRESS] = GBS_OPCODE_HALT;
+    gbs->image[GBS_IDLE_ADDRESS + 1] = GBS_OPCODE_JR;
+    gbs->image[GBS_IDLE_ADDRESS + 2] = static_cast<uint8_t>(-3);
+    std::memcpy(gbs->image.data() + header.loadAddress, data.data() + GBS_HEADER_SIZE, payloadSize);
+    return true;
+}
+
+static bool isGBSIdle(const GameBoy* gb) {
+    return (gb->CPU.currentCycles == 0 || gb->CPU.isHalted) &&
+        gb->CPU.PC >= GBS_IDLE_ADDRESS && gb->CPU.PC < GBS_IDLE_ADDRESS + 3;
+}
+
+static void callGBSRoutine(GameBoy* gb, uint16_t address) {
+    gb->CPU.isHalted = false;
+    gb->CPU.SP -= 2;
+    writeMemoryWord(gb, gb->CPU.SP, GBS_IDLE_ADDRESS);
+    gb->CPU.currentCycles = 0;
+    gb->CPU.PC = address;
+}
+
+static void startGBSTrack(GBSPlayer* player, const GBSFile* gbs, int track, int sampleRate) {
+    player->ram.assign(ERAM_BANK_SIZE, 0);
+    player->cart = {};
+    player->cart.Mapper = MBC::MBC5;
+    player->cart.romBanks = gbs->romBanks;
+    player->cart.ramBanks = 1;
+    player->cart.rom = reinterpret_cast<uint8_t(*)[ROM_BANK_SIZE]>(const_cast<uint8_t*>(gbs->image.data()));
+    player->cart.ram = reinterpret_cast<uint8_t(*)[ERAM_BANK_SIZE]>(player->ram.data());
+    player->cart.MBC5.isRamEnabled = true;
+    player->cart.MBC5.currentRomBank = 1;
+
+    GameBoy* gb = player->gb;
+    resetGameBoy(gb, &player->cart);
+    setAPUOutputFrequency(&gb->apu, sampleRate);
+
+    writeMemoryByte(gb, 0xFF00 | NR52, static_cast<uint8_t>(APUConstants::NR52::APU_ENABLE_BIT));
+    writeMemoryByte(gb, 0xFF00 | NR51, 0xFF);
+    writeMemoryByte(gb, 0xFF00 | NR50, 0x77);
+    writeMemoryByte(gb, 0xFF00 | TMA, gbs->header.timerModulo);
+    writeMemoryByte(gb, 0xFF00 | TAC, gbs->header.timerControl);
+
+    player->playAddress = gbs->header.playAddress;
+    player->timerDriven = (gbs->header.timerControl & 0b100) != 0;
+    player->pendingTick = false;
+    player->frameCycles = 0;
+
+    gb->CPU.A = static_cast<uint8_t>(track);
+    gb->CPU.SP = gbs->header.stackPointer;
+    callGBSRoutine(gb, gbs->header.initAddress);
+}
+
+static void drainGBSAudio(GBSPlayer* player) {
+    GameBoyAPU* apu = &player->gb->apu;
+    if (!apu->isAudioBufferFull) return;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(apu->audioSampleBuffer.data());
+    for (size_t i = 0; i < sizeof(apu->audioSampleBuffer); i++) {
+        player->hash = (player->hash ^ bytes[i]) * GBS_HASH_PRIME;
+    }
+    player->wav.write(reinterpret_cast<const char*>(bytes), sizeof(apu->audioSampleBuffer));
+    player->frames += APUConstants::SAMPLE_BUF_LEN / 2;
+    apu->isAudioBufferFull = false;
+}
+
+static void stepGBSCycle(GBSPlayer* player) {
+    GameBoy* gb = player->gb;
+    updateTimers(gb);
+    if (player->timerDriven && (gb->io[IF] & INTERRUPT_TIMER)) {
+        gb->io[IF] &= ~INTERRUPT_TIMER;
+        player->pendingTick = true;
+    }
+    if (!player->timerDriven && ++player->frameCycles == GBS_FRAME_CYCLES) {
+        player->frameCycles = 0;
+        player->pendingTick = true;
+    }
+    if (++gb->apu.pendingCycles >= gb->apu.cyclesUntilEvent) syncAPU(&gb->apu);
+    CPUClock<MBC::MBC5>(&gb->CPU);
+    drainGBSAudio(player);
+}
+
+static uint32_t idleGBSCycles(const GBSPlayer* player) {
+    const GameBoy* gb = player->gb;
+    uint32_t cycles = player->timerDriven ? GBS_FRAME_CYCLES : GBS_FRAME_CYCLES - player->frameCycles - 1;
+    if (gb->timer_overflow) return 0;
+    if (gb->io[TAC] & 0b100) {
+        uint32_t period = GBS_TIMER_PERIODS[gb->io[TAC] & 0b011];
+        uint32_t firstIncrement = period - (gb->div & (period - 1));
+        uint32_t increments = 256 - gb->io[TIMA];
+        cycles = std::min(cycles, firstIncrement + (increments - 1) * period - 1);
+    }
+    return cycles;
+}
+
+static void skipTimerCycles(GameBoy* gb, uint32_t cycles) {
+    uint32_t start = gb->div;
+    gb->div = static_cast<uint16_t>(start + cycles);
+    if (!(gb->io[TAC] & 0b100)) {
+        gb->prev_timer_inc = false;
+        return;
+    }
+    uint32_t period = GBS_TIMER_PERIODS[gb->io[TAC] & 0b011];
+    gb->io[TIMA] = static_cast<uint8_t>(gb->io[TIMA] + (start + cycles) / period - start / period);
+    gb->prev_timer_inc = (gb->div & (period / 2)) != 0;
+}
+
+static void skipGBSCycles(GBSPlayer* player, uint32_t cycles) {
+    GameBoyAPU* apu = &player->gb->apu;
+    while (cycles > 0) {
+        uint32_t chunk = apu->cyclesUntilEvent > apu->pendingCycles
+            ? std::min(cycles, apu->cyclesUntilEvent - apu->pendingCycles)
+            : 1;
+        skipTimerCycles(player->gb, chunk);
+        if (!player->timerDriven) player->frameCycles += chunk;
+        apu->pendingCycles += chunk;
+        if (apu->pendingCycles >= apu->cyclesUntilEvent) syncAPU(apu);
+        drainGBSAudio(player);
+        cycles -= chunk;
+    }
+}
+
+GBSTrackResult renderGBSTrack(const GBSFile* gbs, int track, int sampleRate, int seconds, const std::string& wavPath) {
+    GBSTrackResult result = { track, false, GBS_HASH_OFFSET, 0, 0.0 };
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<GameBoy, decltype(&free)> gb(
+        reinterpret_cast<GameBoy*>(calloc(1, sizeof(GameBoy))),
+        &free
+    );
+    if (!gb) {
+        std::cerr << "Erreur d'allocation mmoire pour le systme GB" << std::endl;
+        return result;
+    }
+
+    auto player = std::make_unique<GBSPlayer>();
+    player->gb = gb.get();
+    player->hash = GBS_HASH_OFFSET;
+    player->frames = 0;
+    player->wav.open(wavPath, std::ios::binary | std::ios::trunc);
+    if (!player->wav.is_open()) {
+        std::cerr << "Impossible de crer le fichier: " << wavPath << std::endl;
+        return result;
+    }
+    writeWavHeader(player->wav, sampleRate, 0);
+
+    startGBSTrack(player.get(), gbs, track, sampleRate);
+
+    uint64_t totalCycles = static_cast<uint64_t>(seconds) * APUConstants::BASE_FREQUENCY;
+    uint64_t cycles = 0;
+    while (cycles < totalCycles) {
+        if (isGBSIdle(gb.get())) {
+            if (player->pendingTick) {
+                player->pendingTick = false;
+                callGBSRoutine(gb.get(), player->playAddress);
+            }
+            else {
+                uint32_t skip = static_cast<uint32_t>(std::min<uint64_t>(idleGBSCycles(player.get()), totalCycles - cycles));
+                if (skip > 0) {
+                    skipGBSCycles(player.get(), skip);
+                    cycles += skip;
+                    continue;
+                }
+            }
+        }
+        stepGBSCycle(player.get());
+        cycles++;
+    }
+
+    uint64_t dataBytes = player->frames * 2 * sizeof(float);
+    player->wav.seekp(0, std::ios::beg);
+    writeWavHeader(player->wav, sampleRate, static_cast<uint32_t>(std::min<uint64_t>(dataBytes, UINT32_MAX)));
+    player->wav.close();
+
+    result.rendered = !player->wav.fail();
+    result.hash = player->hash;
+    result.frames = player->frames;
+    result.renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::vector<GBSTrackResult> renderGBSTracks(const GBSFile* gbs, int sampleRate, int seconds, const std::string& basename) {
+    int trackCount = gbs->header.songCount;
+    std::vector<GBSTrackResult> results(trackCount);
+
+    WorkerPool pool;
+    startWorkerPool(&pool, std::min(defaultWorkerCount(1), trackCount - 1));
+    parallelFor(&pool, trackCount, [&](int track) {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "_%03d.wav", track + 1);
+        results[track] = renderGBSTrack(gbs, track, sampleRate, seconds, basename + suffix);
+        });
+    return results;
+}
+
+bool runGBSPlayer(const std::string& fileName, int seconds) {
+    GBSFile gbs;
+    if (!loadGBSFile(&gbs, fileName.c_str())) {
+        return false;
+    }
+
+    std::cout << "GBS : " << gbs.header.title << " - " << gbs.header.author
+        << " (" << static_cast<int>(gbs.header.songCount) << " pistes)" << std::endl;
+
+    std::string basename = std::filesystem::path(fileName).replace_extension().string();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<GBSTrackResult> results = renderGBSTracks(&gbs, APUConstants::SAMPLE_FREQ, seconds, basename);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream hashes(basename + "_hashes.txt", std::ios::trunc);
+    bool success = true;
+    for (const GBSTrackResult& result : results) {
+        success = success && result.rendered;
+        std::ostringstream hash;
+        hash << std::hex << std::setw(16) << std::setfill('0') << result.hash;
+        hashes << std::setw(3) << std::setfill('0') << result.track + 1 << " " << hash.str() << "\n";
+        std::cout << "Piste " << result.track + 1 << " : " << hash.str()
+            << " (x" << static_cast<int>(seconds / std::max(result.renderSeconds, 1e-6)) << " temps rel)"
+            << (result.rendered ? "" : " CHEC") << std::endl;
+    }
+    std::cout << results.size() << " pistes rendues en " << std::fixed << std::setprecision(2) << elapsed << " s" << std::endl;
+    return success;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr int GBS_HEADER_SIZE = 0x70;
+constexpr uint16_t GBS_MIN_LOAD_ADDRESS = 0x0400;
+constexpr uint16_t GBS_IDLE_ADDRESS = 0x0100;
+constexpr uint32_t GBS_FRAME_CYCLES = 70224;
+constexpr int GBS_DEFAULT_TRACK_SECONDS = 120;
+
+struct GBSHeader {
+    uint8_t version;
+    uint8_t songCount;
+    uint8_t firstSong;
+    uint16_t loadAddress;
+    uint16_t initAddress;
+    uint16_t playAddress;
+    uint16_t stackPointer;
+    uint8_t timerModulo;
+    uint8_t timerControl;
+    std::string title;
+    std::string author;
+    std::string copyright;
+};
+
+struct GBSFile {
+    GBSHeader header;
+    std::vector<uint8_t> image;
+    int romBanks;
+};
+
+struct GBSTrackResult {
+    int track;
+    bool rendered;
+    uint64_t hash;
+    uint64_t frames;
+    double renderSeconds;
+};
+
+bool isGBSFile(const std::string& fileName);
+bool loadGBSFile(GBSFile* gbs, const char* fileName);
+
+GBSTrackResult renderGBSTrack(const GBSFile* gbs, int track, int sampleRate, int seconds, const std::string& wavPath);
+std::vector<GBSTrackResult> renderGBSTracks(const GBSFile* gbs, int sampleRate, int seconds, const std::string& basename);
+
+bool runGBSPlayer(const std::string& fileName, int seconds);
@@ -1,37 +1,85 @@
 #define SDL_MAIN_HANDLED
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <vector>
 
 #include "APU.hpp"
+#include "APULog.hpp"
+#include "APUThread.hpp"
+#include "AudioOutput.hpp"
 #include "Cartridge.hpp"
 #include "Controller.hpp"
 #include "ErrorHandling.hpp"
 #include "FileDialog.hpp"
+#include "FramePacer.hpp"
+#include "FrameQueue.hpp"
+#include "GBSPlayer.hpp"
 #include "GB.hpp"
 #include "LocaleInitializer.hpp"
+#include "PostProcess.hpp"
 #include "PPU.hpp"
+#include "Recorder.hpp"
+#include "RomLibrary.hpp"
+#include "SaveState.hpp"
+#include "Screenshot.hpp"
 #include "SDLUtils.hpp"
 #include "SM83.hpp"
+#include "TimeStretch.hpp"
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
 
         LocaleInitializer localeInit;
 
-        std::string romPath = OpenFileDialog();
+        std::string romPath = argc > 1 ? argv[1] : OpenFileDialog();
         if (romPath.empty()) {
             ShowInfoMessage(L"Aucun fichier ROM slectionn. Fermeture de l'application.", L"Information");
             return EXIT_SUCCESS;
         }
 
+        if (isRomLibraryDirectory(romPath)) {
+            std::vector<std::string> directories;
+            for (int i = 1; i < argc; i++) {
+                if (isRomLibraryDirectory(argv[i])) {
+                    directories.push_back(argv[i]);
+                }
+            }
+            std::unique_ptr<char, decltype(&SDL_free)> prefPath(SDL_GetPrefPath("GekySan", "GB"), &SDL_free);
+            std::string indexPath = std::string(prefPath ? prefPath.get() : "") + "roms.gbix";
+            return runRomLibraryIndexer(directories, indexPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        if (isGBSFile(romPath)) {
+            int seconds = argc > 2 ? std::atoi(argv[2]) : 0;
+            return runGBSPlayer(romPath, seconds > 0 ? seconds : GBS_DEFAULT_TRACK_SECONDS) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        if (isAPULogFile(romPath)) {
+            std::vector<std::string> logPaths = { romPath };
+            int sampleRate = APUConstants::SAMPLE_FREQ;
+            for (int i = 2; i < argc; i++) {
+                if (isAPULogFile(argv[i])) {
+                    logPaths.push_back(argv[i]);
+                }
+                else if (std::atoi(argv[i]) > 0) {
+                    sampleRate = std::atoi(argv[i]);
+                }
+            }
+            return runAPULogRenderer(logPaths, sampleRate) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
         if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER) != 0) {
             throw std::runtime_error(std::string("chec de l'initialisation de SDL: ") + SDL_GetError());
         }
@@ -40,7 +88,7 @@ int main() {
             ~SDL_Quit_Scope() { SDL_Quit(); }
         } sdl_quit_scope;
 
-        SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, "best");
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
 
         auto controller = InitializeController();
 
@@ -77,17 +125,19 @@ int main() {
             throw std::runtime_error(std::string("chec de la cration de la texture SDL: ") + SDL_GetError());
         }
 
-        SDL_AudioSpec desiredSpec = {};
-        desiredSpec.freq = APUConstants::SAMPLE_FREQ;
-        desiredSpec.format = AUDIO_F32;
-        desiredSpec.channels = 2;
-        desiredSpec.samples = APUConstants::SAMPLE_BUF_LEN / 2;
+        SDL_DisplayMode displayMode = {};
+        int refreshRate = SDL_GetWindowDisplayMode(window.get(), &displayMode) == 0 ? displayMode.refresh_rate : 0;
+
+        FramePacer framePacer;
+        initFramePacer(&framePacer, refreshRate);
+        std::atomic<bool> rateControlToggleRequested = false;
+        std::atomic<bool> fastForwardHeld = false;
+        std::atomic<double> emulationSpeed = 1.0;
 
-        SDL_AudioDeviceID audioDevice = SDL_OpenAudioDevice(nullptr, 0, &desiredSpec, nullptr, 0);
-        if (audioDevice == 0) {
-            throw std::runtime_error("chec de l'ouverture du priphrique audio");
+        AudioOutput audioOutput;
+        if (!openAudioOutput(&audioOutput, APUConstants::SAMPLE_FREQ, AUDIO_DEFAULT_LATENCY_MS)) {
+            throw std::runtime_error(std::string("chec de l'ouverture du priphrique audio: ") + SDL_GetError());
         }
-        SDL_PauseAudioDevice(audioDevice, 0);
 
         std::unique_ptr<GameBoy, decltype(&free)> gbSystem(
             reinterpret_cast<GameBoy*>(calloc(1, sizeof(GameBoy))),
@@ -98,24 +148,214 @@ int main() {
         }
 
         resetGameBoy(gbSystem.get(), cart.get());
-        gbSystem->renderer = renderer.get();
-
-        bool running = true;
-        long currentCycle = 0, frame = 0;
+        setAPUOutputFrequency(&gbSystem->apu, audioOutput.sampleRate);
+
+        auto frameQueue = std::make_unique<FrameQueue>();
+        gbSystem->ppu.frameBuffer = getWriteFrame(frameQueue.get());
+        gbSystem->ppu.frameBufferPitch = SCREEN_WIDTH * sizeof(uint32_t);
+
+        Recorder recorder;
+        initRecorder(&recorder, audioOutput.sampleRate);
+        std::atomic<bool> recordToggleRequested = false;
+
+        TimeStretch timeStretch;
+        initTimeStretch(&timeStretch, audioOutput.sampleRate);
+        AudioRateConverter rateConverter;
+        initAudioRateConverter(&rateConverter, audioOutput.sampleRate);
+        auto playAudioBlock = [&](const float* samples) {
+            if (!fastForwardHeld.load(std::memory_order_relaxed)) {
+                uint32_t frames = 0;
+                const float* output = stretchAudioFrames(&timeStretch, samples, APUConstants::SAMPLE_BUF_LEN / AUDIO_CHANNELS, &frames);
+                output = convertAudioRate(&rateConverter, output, frames, &frames);
+                writeAudioFrames(&audioOutput, output, frames);
+            }
+            recordAudioBlock(&recorder, samples);
+            };
+
+        APULog apuLog;
+        std::atomic<bool> apuLogToggleRequested = false;
+        std::string apuLogBasename;
+        int apuLogSegment = 0;
+
+        ScreenshotWriter screenshots;
+        initScreenshotWriter(&screenshots, MAX_SCALE_FACTOR);
+        std::atomic<bool> deferredToggleRequested = false;
+
+        SaveStateWriter saveStates;
+        initSaveStateWriter(&saveStates);
+        std::string saveStatePath = generateSaveStateFilename(romPath);
+        std::atomic<bool> saveStateRequested = false;
+        std::atomic<bool> loadStateRequested = false;
+
+        std::atomic<bool> running = true;
+        std::atomic<long> emulatedFrames = 0;
         double fps = 0.0;
         auto lastTitleUpdate = std::chrono::steady_clock::now();
-        int framesSinceLastUpdate = 0;
+        long framesAtLastUpdate = 0;
+
+        std::thread emulationThread([&]() {
+            EmulateCycleFunction emulate = getEmulateCycleFunction(cart.get());
+            if (std::thread::hardware_concurrency() >= 4) {
+                startPPUThread(gbSystem.get());
+                startAPUThread(gbSystem.get(), playAudioBlock);
+            }
+
+            while (running.load(std::memory_order_relaxed)) {
+
+                if (gbSystem->CPU.illegalOpcode) {
+                    std::cerr << "Instruction illgale dtecte, arrt du programme\n";
+                    running = false;
+                    break;
+                }
+
+                while (!gbSystem->ppu.isFrameComplete) {
+                    emulate(gbSystem.get());
+
+                    if (gbSystem->apu.isAudioBufferFull) {
+                        playAudioBlock(gbSystem->apu.audioSampleBuffer.data());
+                        gbSystem->apu.isAudioBufferFull = false;
+                    }
+                }
+                gbSystem->ppu.isFrameComplete = false;
+
+                if (gbSystem->ppuThread) {
+                    waitForPPUFrame(gbSystem->ppuThread);
+                }
+                if (gbSystem->apuThread) {
+                    flushAPUThread(gbSystem.get());
+                }
+
+                if (recordToggleRequested.exchange(false, std::memory_order_relaxed)) {
+                    bool apuThreadActive = gbSystem->apuThread != nullptr;
+                    stopAPUThread(gbSystem.get());
+                    if (recorder.active) {
+                        stopRecording(&recorder);
+                    }
+                    else {
+                        startRecording(&recorder, generateRecordingBasename());
+                    }
+                    if (apuThreadActive) {
+                        startAPUThread(gbSystem.get(), playAudioBlock);
+                    }
+                }
+                if (apuLogToggleRequested.exchange(false, std::memory_order_relaxed)) {
+                    if (apuLog.active) {
+                        stopAPULog(&apuLog, gbSystem.get());
+                    }
+                    else {
+                        apuLogBasename = generateRecordingBasename();
+                        apuLogSegment = 0;
+                        startAPULog(&apuLog, gbSystem.get(), apuLogBasename + ".apulog");
+                    }
+                }
+                if (deferredToggleRequested.exchange(false, std::memory_order_relaxed)) {
+                    if (gbSystem->ppuDeferred) {
+                        stopDeferredPPU(gbSystem.get());
+                        if (std::thread::hardware_concurrency() >= 4) {
+                            startPPUThread(gbSystem.get());
+                        }
+                        std::cout << "Rendu diffr dsactiv" << std::endl;
+                    }
+                    else {
+                        stopPPUThread(gbSystem.get());
+                        startDeferredPPU(gbSystem.get(), defaultWorkerCount(2));
+                        std::cout << "Rendu diffr activ" << std::endl;
+                    }
+                }
+                if (saveStateRequested.exchange(false, std::memory_order_relaxed)) {
+                    if (queueSaveState(&saveStates, gbSystem.get(), saveStatePath)) {
+                        std::cout << "tat sauvegard: " << saveStatePath << std::endl;
+                    }
+                }
+                if (loadStateRequested.exchange(false, std::memory_order_relaxed)) {
+                    bool ppuThreadActive = gbSystem->ppuThread != nullptr;
+                    bool ppuDeferredActive = gbSystem->ppuDeferred != nullptr;
+                    bool apuThreadActive = gbSystem->apuThread != nullptr;
+                    bool apuLogActive = apuLog.active;
+                    stopAPUThread(gbSystem.get());
+                    stopPPUThread(gbSystem.get());
+                    stopDeferredPPU(gbSystem.get());
+                    stopAPULog(&apuLog, gbSystem.get());
+
+                    if (loadSaveState(&saveStates, gbSystem.get(), saveStatePath)) {
+                        std::cout << "tat charg: " << saveStatePath << std::endl;
+                    }
+                    if (apuLogActive) {
+                        startAPULog(&apuLog, gbSystem.get(), apuLogBasename + "_" + std::to_string(++apuLogSegment) + ".apulog");
+                    }
+
+                    if (ppuDeferredActive) {
+                        startDeferredPPU(gbSystem.get(), defaultWorkerCount(2));
+                    }
+                    if (ppuThreadActive) {
+                        startPPUThread(gbSystem.get());
+                    }
+                    if (apuThreadActive) {
+                        startAPUThread(gbSystem.get(), playAudioBlock);
+                    }
+                }
+                recordVideoFrame(&recorder, gbSystem->ppu.frameBuffer);
+                captureScreenshotFrame(&screenshots, gbSystem->ppu.frameBuffer);
+
+                gbSystem->ppu.frameBuffer = publishFrame(frameQueue.get());
+                emulatedFrames.fetch_add(1, std::memory_order_relaxed);
+
+                if (rateControlToggleRequested.exchange(false, std::memory_order_relaxed)) {
+                    bool enabled = !framePacer.enabled.load(std::memory_order_relaxed);
+                    framePacer.enabled.store(enabled, std::memory_order_relaxed);
+                    std::cout << (enabled ? "Contrle dynamique du dbit activ" : "Contrle dynamique du dbit dsactiv") << std::endl;
+                }
+                bool fastForward = fastForwardHeld.load(std::memory_order_relaxed);
+                double speed = fastForward ? 1.0 : emulationSpeed.load(std::memory_order_relaxed);
+                setTimeStretchSpeed(&timeStretch, speed);
+                setFramePacerSpeed(&framePacer, speed);
+                bool audioEnabled = !fastForward || recorder.active.load(std::memory_order_relaxed);
+                if (gbSystem->apuThread) {
+                    setAPUThreadAudioEnabled(gbSystem->apuThread, audioEnabled);
+                }
+                else if (gbSystem->apu.audioEnabled != audioEnabled) {
+                    setAPUAudioEnabled(&gbSystem->apu, audioEnabled);
+                }
+                if (!fastForward) {
+                    double rateRatio = 1.0;
+                    if (framePacer.enabled.load(std::memory_order_relaxed)) {
+                        waitForNextFrame(&framePacer);
+                        limitAudioBacklog(&audioOutput);
+                        rateRatio = getFrameRateRatio(&framePacer) * getAudioRateCorrection(&audioOutput);
+                    }
+                    else {
+                        waitForAudioDrain(&audioOutput);
+                    }
+                    setAudioRateRatio(&rateConverter, rateRatio);
+                }
+            }
+
+            stopAPULog(&apuLog, gbSystem.get());
+            stopAPUThread(gbSystem.get());
+            stopPPUThread(gbSystem.get());
+            stopDeferredPPU(gbSystem.get());
+            });
+
+        struct Emulation_Thread_Scope {
+            std::atomic<bool>& running;
+            std::thread& thread;
+            ~Emulation_Thread_Scope() {
+                running = false;
+                if (thread.joinable()) thread.join();
+            }
+        } emulation_thread_scope{ running, emulationThread };
 
         int windowW, windowH;
         SDL_GetWindowSize(window.get(), &windowW, &windowH);
         SDL_Rect dst = { 0, 0, windowW, windowH };
 
-        while (running) {
+        PostProcessor postProcessor;
+        initPostProcessor(&postProcessor, defaultWorkerCount(2));
+        setPostProcessScale(&postProcessor, dst.w, dst.h);
+        int textureW = SCREEN_WIDTH, textureH = SCREEN_HEIGHT;
+        double fastTrigger = 0.0, slowTrigger = 0.0;
 
-            if (gbSystem->CPU.illegalOpcode) {
-                std::cerr << "Instruction illgale dtecte, arrt du programme\n";
-                break;
-            }
+        while (running) {
 
             SDL_Event event;
             while (SDL_PollEvent(&event)) {
@@ -139,60 +379,134 @@ int main() {
                         dst.x = 0;
                         dst.y = (windowH - dst.h) / 2;
                     }
+                    setPostProcessScale(&postProcessor, dst.w, dst.h);
+                }
+
+                else if (event.type == SDL_CONTROLLERBUTTONDOWN) {
+                    if (event.cbutton.button == SDL_CONTROLLER_BUTTON_RIGHTSHOULDER) {
+                        cyclePostProcessFilter(&postProcessor);
+                    }
+                    else if (event.cbutton.button == SDL_CONTROLLER_BUTTON_LEFTSHOULDER) {
+                        toggleLCDGhosting(&postProcessor);
+                    }
+                    else if (event.cbutton.button == SDL_CONTROLLER_BUTTON_X) {
+                        recordToggleRequested = true;
+                    }
+                    else if (event.cbutton.button == SDL_CONTROLLER_BUTTON_GUIDE) {
+                        apuLogToggleRequested = true;
+                    }
+                    else if (event.cbutton.button == SDL_CONTROLLER_BUTTON_Y) {
+                        deferredToggleRequested = true;
+                    }
+                    else if (event.cbutton.button == SDL_CONTROLLER_BUTTON_LEFTSTICK) {
+                        rateControlToggleRequested = true;
+                    }
+                    else if (event.cbutton.button == SDL_CONTROLLER_BUTTON_RIGHTSTICK) {
+                        fastForwardHeld = true;
+                    }
+                    else if (event.cbutton.button == SDL_CONTROLLER_BUTTON_MISC1) {
+                        setScreenshotButton(&screenshots, true);
+                    }
+                }
+
+                else if (event.type == SDL_KEYDOWN && !event.key.repeat) {
+                    if (event.key.keysym.sym == SDLK_F5) {
+                        saveStateRequested = true;
+                    }
+                    else if (event.key.keysym.sym == SDLK_F9) {
+                        loadStateRequested = true;
+                    }
+                }
+
+                else if (event.type == SDL_CONTROLLERBUTTONUP) {
+                    if (event.cbutton.button == SDL_CONTROLLER_BUTTON_RIGHTSTICK) {
+                        fastForwardHeld = false;
+                    }
+                    else if (event.cbutton.button == SDL_CONTROLLER_BUTTON_MISC1) {
+                        setScreenshotButton(&screenshots, false);
+                    }
+                }
+
+                else if (event.type == SDL_CONTROLLERAXISMOTION &&
+                    (event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERRIGHT || event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERLEFT)) {
+                    double depth = std::max(0, event.caxis.value - CONTROLLER_TRIGGER_DEADZONE) / static_cast<double>(SDL_JOYSTICK_AXIS_MAX - CONTROLLER_TRIGGER_DEADZONE);
+                    (event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERRIGHT ? fastTrigger : slowTrigger) = depth;
+
+                    double speed = 1.0;
+                    if (fastTrigger > 0.0) {
+                        speed = TIME_STRETCH_FAST_MIN + (TIME_STRETCH_FAST_MAX - TIME_STRETCH_FAST_MIN) * fastTrigger;
+                    }
+                    else if (slowTrigger > 0.0) {
+                        speed = TIME_STRETCH_SLOW_MAX - (TIME_STRETCH_SLOW_MAX - TIME_STRETCH_SLOW_MIN) * slowTrigger;
+                    }
+                    emulationSpeed = speed;
                 }
 
                 handleGameBoyEvent(gbSystem.get(), &event);
             }
 
-            void* pixels = nullptr;
-            int frameBufferPitch = 0;
-            if (SDL_LockTexture(texture.get(), nullptr, &pixels, &frameBufferPitch) != 0) {
-                throw std::runtime_error(std::string("chec de verrouillage de la texture SDL: ") + SDL_GetError());
+            const uint32_t* latestFrame = acquireLatestFrame(frameQueue.get());
+            if (!latestFrame) {
+                SDL_Delay(1);
+                continue;
             }
 
-            gbSystem->ppu.frameBuffer = static_cast<uint32_t*>(pixels);
-            gbSystem->ppu.frameBufferPitch = frameBufferPitch;
-
-            while (!gbSystem->ppu.isFrameComplete) {
-                emulateCycle(gbSystem.get());
+            const uint32_t* outputFrame = applyPostProcess(&postProcessor, latestFrame);
 
-                if (gbSystem->apu.isAudioBufferFull) {
-                    SDL_QueueAudio(audioDevice, gbSystem->apu.audioSampleBuffer.data(), sizeof(float) * APUConstants::SAMPLE_BUF_LEN);
-                    gbSystem->apu.isAudioBufferFull = false;
+            if (postProcessor.outputWidth != textureW || postProcessor.outputHeight != textureH) {
+                textureW = postProcessor.outputWidth;
+                textureH = postProcessor.outputHeight;
+                texture.reset(SDL_CreateTexture(renderer.get(),
+                    SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, textureW, textureH));
+                if (!texture) {
+                    throw std::runtime_error(std::string("chec de la cration de la texture SDL: ") + SDL_GetError());
                 }
-                ++currentCycle;
             }
-            gbSystem->ppu.isFrameComplete = false;
 
-            SDL_UnlockTexture(texture.get());
+            if (SDL_UpdateTexture(texture.get(), nullptr, outputFrame, textureW * sizeof(uint32_t)) != 0) {
+                throw std::runtime_error(std::string("chec de la mise  jour de la texture SDL: ") + SDL_GetError());
+            }
+
+            SDL_Rect target = dst;
+            int integerScale = std::min(dst.w / textureW, dst.h / textureH);
+            if (integerScale > 0) {
+                target.w = textureW * integerScale;
+                target.h = textureH * integerScale;
+                target.x = dst.x + (dst.w - target.w) / 2;
+                target.y = dst.y + (dst.h - target.h) / 2;
+            }
 
             SDL_RenderClear(renderer.get());
 
-            SDL_RenderCopy(renderer.get(), texture.get(), nullptr, &dst);
+            SDL_RenderCopy(renderer.get(), texture.get(), nullptr, &target);
 
             SDL_RenderPresent(renderer.get());
-
-            ++frame;
-            ++framesSinceLastUpdate;
-
-            while (SDL_GetQueuedAudioSize(audioDevice) > 4 * APUConstants::SAMPLE_BUF_LEN) {
-                SDL_Delay(1);
-            }
+            signalVSync(&framePacer);
 
             auto now = std::chrono::steady_clock::now();
             auto elapsedSinceLastUpdate = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTitleUpdate).count();
 
             if (elapsedSinceLastUpdate >= 1000) {
-                fps = framesSinceLastUpdate * 1000.0 / elapsedSinceLastUpdate;
-                framesSinceLastUpdate = 0;
+                long frames = emulatedFrames.load(std::memory_order_relaxed);
+                fps = (frames - framesAtLastUpdate) * 1000.0 / elapsedSinceLastUpdate;
+                framesAtLastUpdate = frames;
                 lastTitleUpdate = now;
 
-                std::string title = "mulateur Game Boy | " + std::to_string(static_cast<int>(fps)) + " FPS";
+                std::string title = "mulateur Game Boy | " + std::to_string(static_cast<int>(fps)) + " FPS | Audio " +
+                    std::to_string(getAudioFillMilliseconds(&audioOutput)) + " ms";
+                uint32_t underruns = audioOutput.underruns.load(std::memory_order_relaxed);
+                uint32_t overruns = audioOutput.overruns.load(std::memory_order_relaxed);
+                if (underruns || overruns) {
+                    title += " (" + std::to_string(underruns) + " coupures, " + std::to_string(overruns) + " dbordements)";
+                }
                 SDL_SetWindowTitle(window.get(), title.c_str());
             }
         }
 
-        SDL_CloseAudioDevice(audioDevice);
+        running = false;
+        emulationThread.join();
+
+        closeAudioOutput(&audioOutput);
     }
     catch (const std::exception& e) {
 
@@ -3,6 +3,10 @@
 #include "GB.hpp"
 #include "PPU.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 uint8_t reverseByte(uint8_t b) {
     b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
     b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
@@ -203,9 +207,6 @@ void updateTileAndPixelCounters(GameBoyPPU* ppu) {
 }
 
 void initializePixelRendering(GameBoyPPU* ppu) {
-    ppu->GB->io[STAT] &= ~STAT_MODE;
-    ppu->GB->io[STAT] |= STAT_MODE_PIXEL_RENDER;
-
     uint8_t curY = ppu->GB->io[SCY] + ppu->currentScanline;
     ppu->bgTileY = (curY >> 3) & (TILEMAP_DIMENSION_BYTES - 1);
     ppu->bgFineY = curY & 0b111;
@@ -219,7 +220,7 @@ void initializePixelRendering(GameBoyPPU* ppu) {
     resetSpriteTiles(ppu);
 }
 
-void handlePixelRendering(GameBoyPPU* ppu) {
+void renderPixelStep(GameBoyPPU* ppu) {
     if (ppu->currentPixelX == -8) {
         initializePixelRendering(ppu);
     }
@@ -232,6 +233,261 @@ void handlePixelRendering(GameBoyPPU* ppu) {
     updateTileAndPixelCounters(ppu);
 }
 
+uint16_t getBackgroundTileSlot(const GameBoyPPU* ppu, uint8_t tile_index) {
+    if (ppu->GB->io[LCDC] & LCDC_BG_TILE_SELECT) {
+        return tile_index;
+    }
+    return 256 + (int8_t)tile_index;
+}
+
+bool isTilemapRowClean(const GameBoyPPU* ppu, uint16_t tilemap_start, int row, uint64_t generation) {
+    int rowSlot = ((tilemap_start - 0x1800) >> 5) + row;
+    if (ppu->tilemapRowGenerations[rowSlot] > generation) return false;
+
+    const uint8_t* tilemap = &ppu->GB->vram[0][tilemap_start + TILEMAP_DIMENSION_BYTES * row];
+    for (int i = 0; i < TILEMAP_DIMENSION_BYTES; i++) {
+        if (ppu->tileGenerations[getBackgroundTileSlot(ppu, tilemap[i])] > generation) return false;
+    }
+    return true;
+}
+
+bool isWindowVisibleOnScanline(const GameBoyPPU* ppu) {
+    uint8_t lcdc = ppu->GB->io[LCDC];
+    return (lcdc & LCDC_BG_DISPLAY) && (lcdc & LCDC_WINDOW_DISPLAY) &&
+        ppu->isRenderingWindow && ppu->GB->io[WX] - 7 < SCREEN_WIDTH;
+}
+
+bool areScanlineTilesClean(const GameBoyPPU* ppu, uint64_t generation) {
+    uint8_t lcdc = ppu->GB->io[LCDC];
+
+    if (lcdc & LCDC_BG_DISPLAY) {
+        uint8_t curY = ppu->GB->io[SCY] + ppu->currentScanline;
+        uint16_t tilemap_start = (lcdc & LCDC_BG_MAP_SELECT) ? 0x1c00 : 0x1800;
+        if (!isTilemapRowClean(ppu, tilemap_start, (curY >> 3) & (TILEMAP_DIMENSION_BYTES - 1), generation)) {
+            return false;
+        }
+    }
+
+    if (isWindowVisibleOnScanline(ppu)) {
+        uint16_t tilemap_start = (lcdc & LCDC_WINDOW_TILE_SELECT) ? 0x1c00 : 0x1800;
+        if (!isTilemapRowClean(ppu, tilemap_start, (ppu->windowScanline >> 3) & (TILEMAP_DIMENSION_BYTES - 1), generation)) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < ppu->activeSpriteCount; i++) {
+        uint8_t tile_index = ppu->GB->oam[ppu->activeSprites[i] + 2];
+        if (lcdc & LCDC_SPRITE_SIZE) {
+            tile_index &= ~1;
+            if (ppu->tileGenerations[tile_index + 1] > generation) return false;
+        }
+        if (ppu->tileGenerations[tile_index] > generation) return false;
+    }
+
+    return true;
+}
+
+void renderLayerTile(GameBoyPPU* ppu, int map, int entry, uint16_t slot) {
+    const uint8_t* tile = &ppu->GB->vram[0][slot * TILE_SIZE_BYTES];
+    uint8_t* dst = &ppu->backgroundLayers[map][(entry / TILEMAP_DIMENSION_BYTES) * 8][(entry % TILEMAP_DIMENSION_BYTES) * 8];
+    for (int y = 0; y < 8; y++) {
+        uint8_t b0 = tile[2 * y];
+        uint8_t b1 = tile[2 * y + 1];
+        for (int x = 0; x < 8; x++) {
+            dst[y * LAYER_DIMENSION + x] = ((b0 >> (7 - x)) & 1) | (((b1 >> (7 - x)) & 1) << 1);
+        }
+    }
+}
+
+void validateLayerTile(GameBoyPPU* ppu, int map, int entry) {
+    uint16_t slot = getBackgroundTileSlot(ppu, ppu->GB->vram[0][0x1800 + map * TILEMAP_ENTRY_COUNT + entry]);
+    if (ppu->layerTileSlots[map][entry] == slot &&
+        ppu->tileGenerations[slot] <= ppu->layerTileGenerations[map][entry]) {
+        return;
+    }
+    renderLayerTile(ppu, map, entry, slot);
+    ppu->layerTileSlots[map][entry] = slot;
+    ppu->layerTileGenerations[map][entry] = ppu->vramGeneration;
+}
+
+void fetchLayerRow(GameBoyPPU* ppu, int map, uint8_t y, uint8_t x, uint8_t* dst, int count) {
+    int entryRow = (y >> 3) * TILEMAP_DIMENSION_BYTES;
+    int tileCount = ((x & 7) + count + 7) >> 3;
+    for (int i = 0; i < tileCount; i++) {
+        validateLayerTile(ppu, map, entryRow + (((x >> 3) + i) & (TILEMAP_DIMENSION_BYTES - 1)));
+    }
+
+    const uint8_t* row = ppu->backgroundLayers[map][y];
+    int first = count < LAYER_DIMENSION - x ? count : LAYER_DIMENSION - x;
+    std::memcpy(dst, row + x, first);
+    std::memcpy(dst + first, row, count - first);
+}
+
+void renderScanlineFromLayers(GameBoyPPU* ppu) {
+    uint8_t lcdc = ppu->GB->io[LCDC];
+    uint8_t bgIndices[SCREEN_WIDTH] = {};
+
+    if (lcdc & LCDC_BG_DISPLAY) {
+        fetchLayerRow(ppu, (lcdc & LCDC_BG_MAP_SELECT) ? 1 : 0,
+            ppu->GB->io[SCY] + ppu->currentScanline, ppu->GB->io[SCX], bgIndices, SCREEN_WIDTH);
+    }
+
+    if (isWindowVisibleOnScanline(ppu)) {
+        int windowX = ppu->GB->io[WX] - 7;
+        int start = windowX > 0 ? windowX : 0;
+        fetchLayerRow(ppu, (lcdc & LCDC_WINDOW_TILE_SELECT) ? 1 : 0,
+            ppu->windowScanline, start - windowX, bgIndices + start, SCREEN_WIDTH - start);
+    }
+
+    uint32_t* row = &ppu->frameBuffer[ppu->currentScanline * (ppu->frameBufferPitch / 4)];
+    bool sprites = !ppu->GB->dma_active && (lcdc & LCDC_SPRITE_DISPLAY);
+
+    if (!sprites) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            int color = (lcdc & LCDC_BG_DISPLAY) ? (ppu->GB->io[BGP] >> (2 * bgIndices[x])) & 0b11 : 0;
+            row[x] = PALETTE_COLORS[color];
+        }
+        return;
+    }
+
+    if (ppu->activeSpriteCount == 0) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            row[x] = PALETTE_COLORS[bgIndices[x]];
+        }
+        return;
+    }
+
+    resetSpriteTiles(ppu);
+    for (ppu->currentPixelX = -8; ppu->currentPixelX < SCREEN_WIDTH; ppu->currentPixelX++) {
+        int bg_index = ppu->currentPixelX >= 0 ? bgIndices[ppu->currentPixelX] : 0;
+        uint8_t color = getSpriteColor(ppu, bg_index);
+        if (ppu->currentPixelX >= 0) {
+            row[ppu->currentPixelX] = PALETTE_COLORS[color];
+        }
+        shiftSpriteTiles(ppu);
+    }
+    ppu->currentPixelX = -8;
+}
+
+void captureScanlineSignature(GameBoyPPU* ppu, PPULineSignature* signature) {
+    std::memset(signature, 0, sizeof(PPULineSignature));
+    signature->lcdc = ppu->GB->io[LCDC];
+    signature->scx = ppu->GB->io[SCX];
+    signature->scy = ppu->GB->io[SCY];
+    signature->bgp = ppu->GB->io[BGP];
+    signature->obp0 = ppu->GB->io[OBP0];
+    signature->obp1 = ppu->GB->io[OBP1];
+    signature->wx = ppu->GB->io[WX];
+    signature->isRenderingWindow = ppu->isRenderingWindow;
+    signature->dmaActive = ppu->GB->dma_active;
+    signature->activeSpriteCount = ppu->activeSpriteCount;
+    signature->windowScanline = static_cast<int16_t>(ppu->windowScanline);
+    for (int i = 0; i < ppu->activeSpriteCount; i++) {
+        signature->spriteIndices[i] = ppu->activeSprites[i];
+        std::memcpy(signature->spriteAttributes[i], &ppu->GB->oam[ppu->activeSprites[i]], 4);
+    }
+}
+
+bool canReuseScanline(const GameBoyPPU* ppu) {
+    int line = ppu->currentScanline;
+    return ppu->lineCacheValid[line] &&
+        std::memcmp(&ppu->lineCacheSignatures[line], &ppu->scanlineSignature, sizeof(PPULineSignature)) == 0 &&
+        areScanlineTilesClean(ppu, ppu->lineCacheGenerations[line]);
+}
+
+void beginScanlineRendering(GameBoyPPU* ppu) {
+    ppu->GB->io[STAT] &= ~STAT_MODE;
+    ppu->GB->io[STAT] |= STAT_MODE_PIXEL_RENDER;
+
+    captureScanlineSignature(ppu, &ppu->scanlineSignature);
+    ppu->scanlineWindowStart = ppu->windowScanline;
+    ppu->isScanlineCacheable = true;
+    ppu->isReusingScanline = canReuseScanline(ppu);
+    ppu->isScanlinePrerendered = true;
+
+    if (ppu->isReusingScanline) {
+        uint32_t* row = &ppu->frameBuffer[ppu->currentScanline * (ppu->frameBufferPitch / 4)];
+        std::memcpy(row, ppu->lineCache[ppu->currentScanline], sizeof(ppu->lineCache[0]));
+    }
+    else {
+        renderScanlineFromLayers(ppu);
+    }
+
+    if (isWindowVisibleOnScanline(ppu)) {
+        ppu->windowScanline++;
+    }
+}
+
+void endScanlineRendering(GameBoyPPU* ppu) {
+    int line = ppu->currentScanline;
+    if (ppu->isReusingScanline) return;
+
+    ppu->lineCacheValid[line] = ppu->isScanlineCacheable;
+    if (!ppu->isScanlineCacheable) return;
+
+    const uint32_t* row = &ppu->frameBuffer[line * (ppu->frameBufferPitch / 4)];
+    std::memcpy(ppu->lineCache[line], row, sizeof(ppu->lineCache[0]));
+    ppu->lineCacheSignatures[line] = ppu->scanlineSignature;
+    ppu->lineCacheGenerations[line] = ppu->vramGeneration;
+}
+
+void catchUpPrerenderedScanline(GameBoyPPU* ppu) {
+    int target = ppu->currentPixelX;
+    ppu->isReusingScanline = false;
+    ppu->isScanlinePrerendered = false;
+    ppu->windowScanline = ppu->scanlineWindowStart;
+    ppu->currentPixelX = -8;
+    while (ppu->currentPixelX < target) {
+        renderPixelStep(ppu);
+    }
+}
+
+void notifyPPUVRAMWrite(GameBoyPPU* ppu, uint16_t offset) {
+    uint64_t generation = ++ppu->vramGeneration;
+    if (offset < 0x1800) {
+        ppu->tileGenerations[offset >> 4] = generation;
+    }
+    else {
+        ppu->tilemapRowGenerations[(offset - 0x1800) >> 5] = generation;
+    }
+}
+
+void invalidatePPUCaches(GameBoyPPU* ppu) {
+    uint64_t generation = ++ppu->vramGeneration;
+    std::fill(std::begin(ppu->tileGenerations), std::end(ppu->tileGenerations), generation);
+    std::fill(std::begin(ppu->tilemapRowGenerations), std::end(ppu->tilemapRowGenerations), generation);
+    std::fill(std::begin(ppu->lineCacheValid), std::end(ppu->lineCacheValid), false);
+    ppu->isReusingScanline = false;
+    ppu->isScanlinePrerendered = false;
+}
+
+void notifyPPURegisterWrite(GameBoyPPU* ppu) {
+    if (!isDisplayEnabled(ppu) || !isRenderingScanline(ppu)) return;
+    if (ppu->currentPixelX == -8 || ppu->currentPixelX >= SCREEN_WIDTH) return;
+
+    if (ppu->isScanlinePrerendered) {
+        catchUpPrerenderedScanline(ppu);
+    }
+    ppu->isScanlineCacheable = false;
+}
+
+void handlePixelRendering(GameBoyPPU* ppu) {
+    if (ppu->currentPixelX == -8) {
+        beginScanlineRendering(ppu);
+    }
+
+    if (ppu->isScanlinePrerendered) {
+        ppu->currentPixelX++;
+    }
+    else {
+        renderPixelStep(ppu);
+    }
+
+    if (ppu->currentPixelX == SCREEN_WIDTH) {
+        endScanlineRendering(ppu);
+    }
+}
+
 void processSprites(GameBoyPPU* ppu) {
     uint8_t obj_y = ppu->GB->oam[2 * ppu->currentCycle];
     int rel_y = ppu->currentScanline - obj_y + 16;
@@ -321,3 +577,32 @@ void PPUClock(GameBoyPPU* ppu) {
 
     incrementCycleAndScanline(ppu);
 }
+
+void PPURenderDot(GameBoyPPU* ppu) {
+    handlePixelRendering(ppu);
+}
+
+void PPUTimingClock(GameBoyPPU* ppu) {
+    if (!isDisplayEnabled(ppu)) {
+        resetPPU(ppu);
+        return;
+    }
+
+    if (isRenderingScanline(ppu)) {
+        if (ppu->currentCycle < OAM_SCAN_CYCLES) {
+            handleOAMScan(ppu);
+        }
+        else if (ppu->currentCycle == OAM_SCAN_CYCLES) {
+            ppu->GB->io[STAT] &= ~STAT_MODE;
+            ppu->GB->io[STAT] |= STAT_MODE_PIXEL_RENDER;
+        }
+        else if (ppu->currentCycle == OAM_SCAN_CYCLES + PIXEL_TRANSFER_CYCLES) {
+            finalizeScanlineRendering(ppu);
+        }
+    }
+    else if (isVBlankCycle(ppu)) {
+        handleVBlank(ppu);
+    }
+
+    incrementCycleAndScanline(ppu);
+}
@@ -2,6 +2,7 @@
 
 #include <SDL2/SDL.h>
 #include <cstdint>
+#include <type_traits>
 
 constexpr int16_t SCREEN_WIDTH = 160;
 constexpr int16_t SCREEN_HEIGHT = 144;
@@ -9,10 +10,17 @@ constexpr int16_t SCREEN_HEIGHT = 144;
 constexpr int16_t CYCLES_PER_SCANLINE = 456;
 constexpr int16_t TOTAL_SCANLINES = 154;
 constexpr int16_t OAM_SCAN_CYCLES = 80;
+constexpr int16_t PIXEL_TRANSFER_CYCLES = SCREEN_WIDTH + 8;
 
 constexpr int16_t TILE_SIZE_BYTES = 16;
 constexpr int16_t TILEMAP_DIMENSION_BYTES = 32;
 
+constexpr int16_t TILE_SLOT_COUNT = 384;
+constexpr int16_t TILEMAP_ROW_COUNT = 2 * TILEMAP_DIMENSION_BYTES;
+constexpr int16_t TILEMAP_COUNT = 2;
+constexpr int16_t TILEMAP_ENTRY_COUNT = TILEMAP_DIMENSION_BYTES * TILEMAP_DIMENSION_BYTES;
+constexpr int16_t LAYER_DIMENSION = TILEMAP_DIMENSION_BYTES * 8;
+
 constexpr int8_t MAX_SPRITES_PER_SCANLINE = 10;
 constexpr int8_t SPRITE_HEIGHT_NORMAL = 8;
 constexpr int8_t SPRITE_HEIGHT_LARGE = 16;
@@ -60,6 +68,24 @@ enum STATMode {
 
 struct GameBoy;
 
+struct PPULineSignature {
+    uint8_t lcdc;
+    uint8_t scx;
+    uint8_t scy;
+    uint8_t bgp;
+    uint8_t obp0;
+    uint8_t obp1;
+    uint8_t wx;
+    bool isRenderingWindow;
+    bool dmaActive;
+    uint8_t activeSpriteCount;
+    int16_t windowScanline;
+    uint8_t spriteIndices[MAX_SPRITES_PER_SCANLINE];
+    uint8_t spriteAttributes[MAX_SPRITES_PER_SCANLINE][4];
+};
+
+static_assert(std::has_unique_object_representations_v<PPULineSignature>);
+
 struct GameBoyPPU {
 
     GameBoy* GB;
@@ -87,6 +113,31 @@ struct GameBoyPPU {
     uint8_t spriteBGPriority;
     uint8_t activeSprites[10];
     uint8_t activeSpriteCount;
+
+    bool isReusingScanline;
+    bool isScanlinePrerendered;
+    bool isScanlineCacheable;
+    int scanlineWindowStart;
+    PPULineSignature scanlineSignature;
+
+    uint64_t vramGeneration;
+    uint64_t tileGenerations[TILE_SLOT_COUNT];
+    uint64_t tilemapRowGenerations[TILEMAP_ROW_COUNT];
+
+    bool lineCacheValid[SCREEN_HEIGHT];
+    uint64_t lineCacheGenerations[SCREEN_HEIGHT];
+    PPULineSignature lineCacheSignatures[SCREEN_HEIGHT];
+    uint32_t lineCache[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+    uint16_t layerTileSlots[TILEMAP_COUNT][TILEMAP_ENTRY_COUNT];
+    uint64_t layerTileGenerations[TILEMAP_COUNT][TILEMAP_ENTRY_COUNT];
+    uint8_t backgroundLayers[TILEMAP_COUNT][LAYER_DIMENSION][LAYER_DIMENSION];
 };
 
+void notifyPPUVRAMWrite(GameBoyPPU* ppu, uint16_t offset);
+void notifyPPURegisterWrite(GameBoyPPU* ppu);
+void invalidatePPUCaches(GameBoyPPU* ppu);
+
 void PPUClock(GameBoyPPU* ppu);
+void PPURenderDot(GameBoyPPU* ppu);
+void PPUTimingClock(GameBoyPPU* ppu);
@@ -0,0 +1,224 @@
+#include "PPUDeferred.hpp"
+
+#include "GB.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+struct PPUMemoryVersion {
+    uint64_t id;
+    uint8_t vram[VRAM_BANK_SIZE];
+    uint8_t oam[OAM_SIZE];
+    uint64_t vramGeneration;
+    uint64_t tileGenerations[TILE_SLOT_COUNT];
+    uint64_t tilemapRowGenerations[TILEMAP_ROW_COUNT];
+};
+
+PPUDeferred::~PPUDeferred() {
+    stopWorkerPool(&pool);
+    for (GameBoy* shadow : shadows) {
+        std::free(shadow);
+    }
+}
+
+static int nextPixelOfScanline(const GameBoyPPU* ppu) {
+    return ppu->currentCycle - OAM_SCAN_CYCLES - 8;
+}
+
+static bool isMidScanline(const GameBoy* gb) {
+    if (!(gb->io[LCDC] & LCDC_DISPLAY_ENABLE) || gb->ppu.currentScanline >= SCREEN_HEIGHT) return false;
+    int pixel = nextPixelOfScanline(&gb->ppu);
+    return pixel > -8 && pixel < SCREEN_WIDTH;
+}
+
+static uint32_t snapshotMemory(PPUDeferred* deferred) {
+    if (deferred->versionCount == deferred->versions.size()) {
+        deferred->versions.push_back(std::make_unique<PPUMemoryVersion>());
+    }
+    PPUMemoryVersion* version = deferred->versions[deferred->versionCount].get();
+    const GameBoy* gb = deferred->GB;
+
+    version->id = deferred->nextVersionId++;
+    std::memcpy(version->vram, gb->vram[0], sizeof(version->vram));
+    std::memcpy(version->oam, gb->oam, sizeof(version->oam));
+    version->vramGeneration = gb->ppu.vramGeneration;
+    std::memcpy(version->tileGenerations, gb->ppu.tileGenerations, sizeof(version->tileGenerations));
+    std::memcpy(version->tilemapRowGenerations, gb->ppu.tilemapRowGenerations, sizeof(version->tilemapRowGenerations));
+
+    deferred->memoryDirty = false;
+    return deferred->versionCount++;
+}
+
+static void beginDeferredScanline(PPUDeferred* deferred) {
+    GameBoy* gb = deferred->GB;
+    PPULineRecord& line = deferred->lines[gb->ppu.currentScanline];
+
+    if (gb->ppu.currentScanline == 0 && deferred->pendingLines > 0) {
+        flushDeferredFrame(deferred);
+    }
+    if (deferred->memoryDirty || deferred->versionCount == 0) {
+        snapshotMemory(deferred);
+    }
+
+    if (!line.pending) deferred->pendingLines++;
+    line.pending = true;
+    std::memcpy(line.registers, &gb->io[LCDC], sizeof(line.registers));
+    line.dmaActive = gb->dma_active;
+    line.isRenderingWindow = gb->ppu.isRenderingWindow;
+    line.windowScanline = gb->ppu.windowScanline;
+    std::memcpy(line.activeSprites, gb->ppu.activeSprites, sizeof(line.activeSprites));
+    line.activeSpriteCount = gb->ppu.activeSpriteCount;
+    line.version = deferred->versionCount - 1;
+    line.firstWrite = static_cast<uint32_t>(deferred->midlineWrites.size());
+    line.writeCount = 0;
+}
+
+static bool isWindowTriggered(uint8_t lcdc, uint8_t wx, bool isRenderingWindow, int begin, int end) {
+    int windowX = wx - 7;
+    return (lcdc & LCDC_BG_DISPLAY) && (lcdc & LCDC_WINDOW_DISPLAY) && isRenderingWindow &&
+        windowX >= begin && windowX < end;
+}
+
+static void endDeferredScanline(PPUDeferred* deferred) {
+    GameBoy* gb = deferred->GB;
+    const PPULineRecord& line = deferred->lines[gb->ppu.currentScanline];
+
+    uint8_t lcdc = line.registers[0];
+    uint8_t wx = line.registers[WX - LCDC];
+    int begin = -8;
+    for (uint32_t i = 0; i < line.writeCount; i++) {
+        const PPUWrite& write = deferred->midlineWrites[line.firstWrite + i];
+        int end = static_cast<int>(write.dot) - 8;
+        if (isWindowTriggered(lcdc, wx, line.isRenderingWindow, begin, end)) gb->ppu.windowScanline++;
+        if (write.address == 0xFF00 + LCDC) lcdc = write.value;
+        if (write.address == 0xFF00 + WX) wx = write.value;
+        begin = end;
+    }
+    if (isWindowTriggered(lcdc, wx, line.isRenderingWindow, begin, SCREEN_WIDTH)) gb->ppu.windowScanline++;
+}
+
+static void loadMemoryVersion(PPUDeferred* deferred, int shadowIndex, const PPUMemoryVersion* version) {
+    if (deferred->shadowVersionIds[shadowIndex] == version->id) return;
+
+    GameBoy* shadow = deferred->shadows[shadowIndex];
+    std::memcpy(shadow->vram[0], version->vram, sizeof(version->vram));
+    std::memcpy(shadow->oam, version->oam, sizeof(version->oam));
+    shadow->ppu.vramGeneration = version->vramGeneration;
+    std::memcpy(shadow->ppu.tileGenerations, version->tileGenerations, sizeof(version->tileGenerations));
+    std::memcpy(shadow->ppu.tilemapRowGenerations, version->tilemapRowGenerations, sizeof(version->tilemapRowGenerations));
+    deferred->shadowVersionIds[shadowIndex] = version->id;
+}
+
+static void renderDeferredScanline(PPUDeferred* deferred, int shadowIndex, int scanline) {
+    const PPULineRecord& line = deferred->lines[scanline];
+    GameBoy* shadow = deferred->shadows[shadowIndex];
+    loadMemoryVersion(deferred, shadowIndex, deferred->versions[line.version].get());
+
+    std::memcpy(&shadow->io[LCDC], line.registers, sizeof(line.registers));
+    shadow->dma_active = line.dmaActive;
+
+    GameBoyPPU* ppu = &shadow->ppu;
+    ppu->frameBuffer = deferred->GB->ppu.frameBuffer;
+    ppu->frameBufferPitch = deferred->GB->ppu.frameBufferPitch;
+    ppu->currentScanline = scanline;
+    ppu->currentPixelX = -8;
+    ppu->isRenderingWindow = line.isRenderingWindow;
+    ppu->windowScanline = line.windowScanline;
+    std::memcpy(ppu->activeSprites, line.activeSprites, sizeof(line.activeSprites));
+    ppu->activeSpriteCount = line.activeSpriteCount;
+
+    uint32_t next = line.firstWrite;
+    uint32_t end = line.firstWrite + line.writeCount;
+    while (ppu->currentPixelX < SCREEN_WIDTH) {
+        PPURenderDot(ppu);
+        while (next < end && deferred->midlineWrites[next].dot == static_cast<uint64_t>(ppu->currentPixelX + 8)) {
+            applyPPUWrite(shadow, deferred->midlineWrites[next]);
+            next++;
+        }
+        if (!(shadow->io[LCDC] & LCDC_DISPLAY_ENABLE)) break;
+    }
+}
+
+void startDeferredPPU(GameBoy* gb, int workerCount) {
+    if (gb->ppuDeferred) return;
+
+    PPUDeferred* deferred = new PPUDeferred();
+    deferred->GB = gb;
+    startWorkerPool(&deferred->pool, workerCount);
+
+    int participants = workerCount + 1;
+    for (int i = 0; i < participants; i++) {
+        GameBoy* shadow = reinterpret_cast<GameBoy*>(std::calloc(1, sizeof(GameBoy)));
+        shadow->ppu = gb->ppu;
+        shadow->ppu.GB = shadow;
+        deferred->shadows.push_back(shadow);
+        deferred->shadowVersionIds.push_back(0);
+    }
+    deferred->midlineWrites.reserve(1024);
+
+    gb->ppuDeferred = deferred;
+}
+
+void stopDeferredPPU(GameBoy* gb) {
+    PPUDeferred* deferred = gb->ppuDeferred;
+    if (!deferred) return;
+
+    flushDeferredFrame(deferred);
+    gb->ppuDeferred = nullptr;
+    delete deferred;
+}
+
+void logDeferredPPUWrite(PPUDeferred* deferred, uint16_t address, uint8_t value) {
+    if (address < 0xFF00) {
+        deferred->memoryDirty = true;
+        return;
+    }
+
+    GameBoy* gb = deferred->GB;
+    if (!isMidScanline(gb)) return;
+
+    PPULineRecord& line = deferred->lines[gb->ppu.currentScanline];
+    deferred->midlineWrites.push_back({ static_cast<uint64_t>(nextPixelOfScanline(&gb->ppu) + 8), address, value });
+    line.writeCount++;
+}
+
+void advanceDeferredPPU(PPUDeferred* deferred) {
+    const GameBoy* gb = deferred->GB;
+    if (!(gb->io[LCDC] & LCDC_DISPLAY_ENABLE)) return;
+
+    if (gb->ppu.currentScanline < SCREEN_HEIGHT) {
+        if (gb->ppu.currentCycle == OAM_SCAN_CYCLES + 1) {
+            beginDeferredScanline(deferred);
+        }
+        else if (gb->ppu.currentCycle == OAM_SCAN_CYCLES + PIXEL_TRANSFER_CYCLES + 1) {
+            endDeferredScanline(deferred);
+        }
+    }
+    else if (gb->ppu.currentScanline == SCREEN_HEIGHT && gb->ppu.currentCycle == 1) {
+        flushDeferredFrame(deferred);
+    }
+}
+
+void flushDeferredFrame(PPUDeferred* deferred) {
+    if (deferred->pendingLines > 0) {
+        int participants = static_cast<int>(deferred->shadows.size());
+        parallelFor(&deferred->pool, participants, [&](int shadowIndex) {
+            int begin = SCREEN_HEIGHT * shadowIndex / participants;
+            int end = SCREEN_HEIGHT * (shadowIndex + 1) / participants;
+            for (int scanline = begin; scanline < end; scanline++) {
+                if (deferred->lines[scanline].pending) {
+                    renderDeferredScanline(deferred, shadowIndex, scanline);
+                }
+            }
+            });
+
+        for (PPULineRecord& line : deferred->lines) {
+            line.pending = false;
+        }
+        deferred->pendingLines = 0;
+    }
+
+    deferred->midlineWrites.clear();
+    deferred->versionCount = 0;
+    deferred->memoryDirty = true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "PPU.hpp"
+#include "PPUThread.hpp"
+#include "WorkerPool.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct GameBoy;
+struct PPUMemoryVersion;
+
+struct PPULineRecord {
+    bool pending;
+    uint8_t registers[12];
+    bool dmaActive;
+    bool isRenderingWindow;
+    int windowScanline;
+    uint8_t activeSprites[MAX_SPRITES_PER_SCANLINE];
+    uint8_t activeSpriteCount;
+    uint32_t version;
+    uint32_t firstWrite;
+    uint32_t writeCount;
+};
+
+struct PPUDeferred {
+    GameBoy* GB;
+
+    std::array<PPULineRecord, SCREEN_HEIGHT> lines{};
+    int pendingLines = 0;
+    std::vector<PPUWrite> midlineWrites;
+
+    std::vector<std::unique_ptr<PPUMemoryVersion>> versions;
+    uint32_t versionCount = 0;
+    uint64_t nextVersionId = 1;
+    bool memoryDirty = true;
+
+    std::vector<GameBoy*> shadows;
+    std::vector<uint64_t> shadowVersionIds;
+    WorkerPool pool;
+
+    ~PPUDeferred();
+};
+
+void startDeferredPPU(GameBoy* gb, int workerCount);
+void stopDeferredPPU(GameBoy* gb);
+
+void logDeferredPPUWrite(PPUDeferred* deferred, uint16_t address, uint8_t value);
+void advanceDeferredPPU(PPUDeferred* deferred);
+void flushDeferredFrame(PPUDeferred* deferred);
@@ -0,0 +1,131 @@
+#include "PPUThread.hpp"
+
+#include "GB.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+void applyPPUWrite(GameBoy* shadow, const PPUWrite& write) {
+    if (write.address >= 0x8000 && write.address < 0xA000) {
+        notifyPPUVRAMWrite(&shadow->ppu, write.address & 0x1FFF);
+        shadow->vram[0][write.address & 0x1FFF] = write.value;
+    }
+    else if (write.address >= 0xFE00 && write.address < 0xFEA0) {
+        shadow->oam[write.address - 0xFE00] = write.value;
+    }
+    else if (write.address == PPU_LOG_DMA_STATE) {
+        notifyPPURegisterWrite(&shadow->ppu);
+        shadow->dma_active = write.value != 0;
+    }
+    else {
+        notifyPPURegisterWrite(&shadow->ppu);
+        shadow->io[write.address & 0x7F] = write.value;
+    }
+}
+
+static void wakePPUThread(PPUThread* thread) {
+    thread->wakeSequence.fetch_add(1, std::memory_order_release);
+    thread->wakeSequence.notify_one();
+}
+
+static void ppuWorkerLoop(PPUThread* thread) {
+    GameBoy* shadow = thread->shadow;
+    uint64_t dot = thread->renderedDot.load(std::memory_order_relaxed);
+
+    while (true) {
+        uint32_t wake = thread->wakeSequence.load(std::memory_order_acquire);
+        if (thread->stopping.load(std::memory_order_relaxed)) break;
+
+        uint64_t ready = thread->readyDot.load(std::memory_order_acquire);
+        if (dot >= ready) {
+            thread->wakeSequence.wait(wake, std::memory_order_acquire);
+            continue;
+        }
+
+        shadow->ppu.frameBuffer = thread->GB->ppu.frameBuffer;
+        shadow->ppu.frameBufferPitch = thread->GB->ppu.frameBufferPitch;
+
+        uint32_t tail = thread->tail.load(std::memory_order_relaxed);
+        uint32_t head = thread->head.load(std::memory_order_acquire);
+        for (; dot < ready; dot++) {
+            while (tail != head && thread->log[tail % PPU_LOG_CAPACITY].dot <= dot) {
+                applyPPUWrite(shadow, thread->log[tail % PPU_LOG_CAPACITY]);
+                tail++;
+            }
+            PPUClock(&shadow->ppu);
+        }
+        shadow->ppu.isFrameComplete = false;
+
+        thread->tail.store(tail, std::memory_order_release);
+        thread->tail.notify_one();
+        thread->renderedDot.store(dot, std::memory_order_release);
+        thread->renderedDot.notify_one();
+    }
+}
+
+void startPPUThread(GameBoy* gb) {
+    if (gb->ppuThread) return;
+
+    PPUThread* thread = new PPUThread();
+    thread->GB = gb;
+    thread->shadow = reinterpret_cast<GameBoy*>(std::calloc(1, sizeof(GameBoy)));
+    std::memcpy(thread->shadow->vram, gb->vram, sizeof(gb->vram));
+    std::memcpy(thread->shadow->oam, gb->oam, sizeof(gb->oam));
+    std::memcpy(thread->shadow->io, gb->io, sizeof(gb->io));
+    thread->shadow->dma_active = gb->dma_active;
+    thread->shadow->ppu = gb->ppu;
+    thread->shadow->ppu.GB = thread->shadow;
+
+    gb->ppuThread = thread;
+    thread->worker = std::thread(ppuWorkerLoop, thread);
+}
+
+void stopPPUThread(GameBoy* gb) {
+    PPUThread* thread = gb->ppuThread;
+    if (!thread) return;
+
+    waitForPPUFrame(thread);
+    thread->stopping.store(true, std::memory_order_relaxed);
+    wakePPUThread(thread);
+    thread->worker.join();
+
+    uint32_t* frameBuffer = gb->ppu.frameBuffer;
+    int frameBufferPitch = gb->ppu.frameBufferPitch;
+    gb->ppu = thread->shadow->ppu;
+    gb->ppu.GB = gb;
+    gb->ppu.frameBuffer = frameBuffer;
+    gb->ppu.frameBufferPitch = frameBufferPitch;
+
+    gb->ppuThread = nullptr;
+    std::free(thread->shadow);
+    delete thread;
+}
+
+void logPPUWrite(PPUThread* thread, uint16_t address, uint8_t value) {
+    uint32_t head = thread->head.load(std::memory_order_relaxed);
+    uint32_t tail;
+    while (head - (tail = thread->tail.load(std::memory_order_acquire)) == PPU_LOG_CAPACITY) {
+        thread->readyDot.store(thread->dot, std::memory_order_release);
+        wakePPUThread(thread);
+        thread->tail.wait(tail, std::memory_order_acquire);
+    }
+    thread->log[head % PPU_LOG_CAPACITY] = { thread->dot, address, value };
+    thread->head.store(head + 1, std::memory_order_release);
+}
+
+void advancePPUThread(PPUThread* thread, bool scanlineComplete) {
+    thread->dot++;
+    if (scanlineComplete) {
+        thread->readyDot.store(thread->dot, std::memory_order_release);
+        wakePPUThread(thread);
+    }
+}
+
+void waitForPPUFrame(PPUThread* thread) {
+    thread->readyDot.store(thread->dot, std::memory_order_release);
+    wakePPUThread(thread);
+    uint64_t rendered;
+    while ((rendered = thread->renderedDot.load(std::memory_order_acquire)) < thread->dot) {
+        thread->renderedDot.wait(rendered, std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <thread>
+
+constexpr uint32_t PPU_LOG_CAPACITY = 1 << 16;
+constexpr uint16_t PPU_LOG_DMA_STATE = 0xFF46;
+
+struct GameBoy;
+
+struct PPUWrite {
+    uint64_t dot;
+    uint16_t address;
+    uint8_t value;
+};
+
+struct PPUThread {
+    GameBoy* GB;
+    GameBoy* shadow;
+
+    std::array<PPUWrite, PPU_LOG_CAPACITY> log;
+    std::atomic<uint32_t> head = 0;
+    std::atomic<uint32_t> tail = 0;
+
+    uint64_t dot = 0;
+    std::atomic<uint64_t> readyDot = 0;
+    std::atomic<uint64_t> renderedDot = 0;
+    std::atomic<uint32_t> wakeSequence = 0;
+
+    std::atomic<bool> stopping = false;
+    std::thread worker;
+};
+
+void startPPUThread(GameBoy* gb);
+void stopPPUThread(GameBoy* gb);
+
+void applyPPUWrite(GameBoy* shadow, const PPUWrite& write);
+void logPPUWrite(PPUThread* thread, uint16_t address, uint8_t value);
+void advancePPUThread(PPUThread* thread, bool scanlineComplete);
+void waitForPPUFrame(PPUThread* thread);
@@ -0,0 +1,353 @@
+#include "PostProcess.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POSTPROCESS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static inline uint32_t averagePixels(uint32_t a, uint32_t b) {
+    return ((a & 0xFEFEFEFE) >> 1) + ((b & 0xFEFEFEFE) >> 1) + (a & b & 0x01010101);
+}
+
+static inline uint32_t blendPixels(uint32_t current, uint32_t previous, int weight) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t c = (current >> shift) & 0xFF;
+        uint32_t p = (previous >> shift) & 0xFF;
+        result |= (((c * (256 - weight) + p * weight) >> 8) & 0xFF) << shift;
+    }
+    return result;
+}
+
+static inline uint32_t toLuma(uint32_t pixel) {
+    int r = (pixel >> 16) & 0xFF;
+    int g = (pixel >> 8) & 0xFF;
+    int b = pixel & 0xFF;
+    int y = (77 * r + 150 * g + 29 * b) >> 8;
+    int u = ((-43 * r - 85 * g + 128 * b) >> 8) + 128;
+    int v = ((128 * r - 107 * g - 21 * b) >> 8) + 128;
+    return (static_cast<uint32_t>(y) << 16) | (static_cast<uint32_t>(u) << 8) | static_cast<uint32_t>(v);
+}
+
+static inline int lumaDistance(uint32_t a, uint32_t b) {
+    int dy = std::abs(static_cast<int>((a >> 16) & 0xFF) - static_cast<int>((b >> 16) & 0xFF));
+    int du = std::abs(static_cast<int>((a >> 8) & 0xFF) - static_cast<int>((b >> 8) & 0xFF));
+    int dv = std::abs(static_cast<int>(a & 0xFF) - static_cast<int>(b & 0xFF));
+    return 48 * dy + 7 * du + 6 * dv;
+}
+
+static void blendGhostRows(uint32_t* ghost, const uint32_t* frame, int begin, int end) {
+    int x = begin;
+#ifdef POSTPROCESS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i currentWeight = _mm_set1_epi16(256 - LCD_GHOSTING_WEIGHT);
+    const __m128i previousWeight = _mm_set1_epi16(LCD_GHOSTING_WEIGHT);
+    for (; x + 4 <= end; x += 4) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame + x));
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ghost + x));
+        __m128i lo = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), currentWeight),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), previousWeight));
+        __m128i hi = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), currentWeight),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), previousWeight));
+        __m128i blended = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(ghost + x), blended);
+    }
+#endif
+    for (; x < end; x++) {
+        ghost[x] = blendPixels(frame[x], ghost[x], LCD_GHOSTING_WEIGHT);
+    }
+}
+
+static void scaleRowNearest(const uint32_t* src, int width, uint32_t* dst, int factor) {
+    int x = 0;
+#ifdef POSTPROCESS_SSE2
+    if (factor == 2) {
+        for (; x + 4 <= width; x += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * x), _mm_unpacklo_epi32(v, v));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * x + 4), _mm_unpackhi_epi32(v, v));
+        }
+    }
+    else if (factor == 4) {
+        for (; x + 4 <= width; x += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x), _mm_shuffle_epi32(v, 0x00));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x + 4), _mm_shuffle_epi32(v, 0x55));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x + 8), _mm_shuffle_epi32(v, 0xAA));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x + 12), _mm_shuffle_epi32(v, 0xFF));
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        std::fill_n(dst + factor * x, factor, src[x]);
+    }
+}
+
+static void scaleNearest(WorkerPool* pool, const uint32_t* src, int width, int height, uint32_t* dst, int factor) {
+    int dstWidth = width * factor;
+    parallelForRows(pool, height, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            uint32_t* row = dst + y * factor * dstWidth;
+            scaleRowNearest(src + y * width, width, row, factor);
+            for (int i = 1; i < factor; i++) {
+                std::memcpy(row + i * dstWidth, row, dstWidth * sizeof(uint32_t));
+            }
+        }
+        });
+}
+
+static void scaleNearestTo(WorkerPool* pool, const uint32_t* src, int width, int height, uint32_t* dst, int dstWidth, int dstHeight) {
+    std::vector<int> columns(dstWidth);
+    for (int x = 0; x < dstWidth; x++) {
+        columns[x] = x * width / dstWidth;
+    }
+    parallelForRows(pool, dstHeight, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            const uint32_t* row = src + (y * height / dstHeight) * width;
+            uint32_t* out = dst + y * dstWidth;
+            for (int x = 0; x < dstWidth; x++) {
+                out[x] = row[columns[x]];
+            }
+        }
+        });
+}
+
+static void scale2x(WorkerPool* pool, const uint32_t* src, int width, int height, uint32_t* dst) {
+    int dstWidth = width * 2;
+    parallelForRows(pool, height, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            const uint32_t* above = src + std::max(y - 1, 0) * width;
+            const uint32_t* row = src + y * width;
+            const uint32_t* below = src + std::min(y + 1, height - 1) * width;
+            uint32_t* out0 = dst + (2 * y) * dstWidth;
+            uint32_t* out1 = out0 + dstWidth;
+            for (int x = 0; x < width; x++) {
+                int left = std::max(x - 1, 0);
+                int right = std::min(x + 1, width - 1);
+                uint32_t B = above[x], D = row[left], E = row[x], F = row[right], H = below[x];
+                if (B != H && D != F) {
+                    out0[2 * x] = D == B ? D : E;
+                    out0[2 * x + 1] = B == F ? F : E;
+                    out1[2 * x] = D == H ? D : E;
+                    out1[2 * x + 1] = H == F ? F : E;
+                }
+                else {
+                    out0[2 * x] = out0[2 * x + 1] = out1[2 * x] = out1[2 * x + 1] = E;
+                }
+            }
+        }
+        });
+}
+
+static void scale3x(WorkerPool* pool, const uint32_t* src, int width, int height, uint32_t* dst) {
+    int dstWidth = width * 3;
+    parallelForRows(pool, height, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            const uint32_t* above = src + std::max(y - 1, 0) * width;
+            const uint32_t* row = src + y * width;
+            const uint32_t* below = src + std::min(y + 1, height - 1) * width;
+            uint32_t* out0 = dst + (3 * y) * dstWidth;
+            uint32_t* out1 = out0 + dstWidth;
+            uint32_t* out2 = out1 + dstWidth;
+            for (int x = 0; x < width; x++) {
+                int left = std::max(x - 1, 0);
+                int right = std::min(x + 1, width - 1);
+                uint32_t A = above[left], B = above[x], C = above[right];
+                uint32_t D = row[left], E = row[x], F = row[right];
+                uint32_t G = below[left], H = below[x], I = below[right];
+                uint32_t* o0 = out0 + 3 * x;
+                uint32_t* o1 = out1 + 3 * x;
+                uint32_t* o2 = out2 + 3 * x;
+                if (B != H && D != F) {
+                    o0[0] = D == B ? D : E;
+                    o0[1] = (D == B && E != C) || (B == F && E != A) ? B : E;
+                    o0[2] = B == F ? F : E;
+                    o1[0] = (D == B && E != G) || (D == H && E != A) ? D : E;
+                    o1[1] = E;
+                    o1[2] = (B == F && E != I) || (H == F && E != C) ? F : E;
+                    o2[0] = D == H ? D : E;
+                    o2[1] = (D == H && E != I) || (H == F && E != G) ? H : E;
+                    o2[2] = H == F ? F : E;
+                }
+                else {
+                    o0[0] = o0[1] = o0[2] = E;
+                    o1[0] = o1[1] = o1[2] = E;
+                    o2[0] = o2[1] = o2[2] = E;
+                }
+            }
+        }
+        });
+}
+
+static void xbr2x(WorkerPool* pool, const uint32_t* src, uint32_t* padded, uint32_t* luma, int width, int height, uint32_t* dst) {
+    int stride = width + 2 * XBR_BORDER;
+    parallelForRows(pool, height + 2 * XBR_BORDER, [&](int begin, int end) {
+        for (int py = begin; py < end; py++) {
+            const uint32_t* row = src + std::clamp(py - XBR_BORDER, 0, height - 1) * width;
+            for (int px = 0; px < stride; px++) {
+                uint32_t pixel = row[std::clamp(px - XBR_BORDER, 0, width - 1)];
+                padded[py * stride + px] = pixel;
+                luma[py * stride + px] = toLuma(pixel);
+            }
+        }
+        });
+
+    int dstWidth = width * 2;
+    parallelForRows(pool, height, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            for (int x = 0; x < width; x++) {
+                int E = (y + XBR_BORDER) * stride + x + XBR_BORDER;
+                for (int corner = 0; corner < 4; corner++) {
+                    int dx = (corner & 1) ? 1 : -1;
+                    int dy = (corner & 2) ? stride : -stride;
+                    int F = E + dx, H = E + dy, I = E + dx + dy;
+                    int B = E - dy, D = E - dx, C = E + dx - dy, G = E - dx + dy;
+                    int F4 = E + 2 * dx, I4 = E + 2 * dx + dy, H5 = E + 2 * dy, I5 = E + dx + 2 * dy;
+
+                    uint32_t out = padded[E];
+                    if (padded[E] != padded[F] && padded[E] != padded[H]) {
+                        int edgeAcross =
+                            lumaDistance(luma[E], luma[C]) + lumaDistance(luma[E], luma[G]) +
+                            lumaDistance(luma[I], luma[F4]) + lumaDistance(luma[I], luma[H5]) +
+                            4 * lumaDistance(luma[H], luma[F]);
+                        int edgeAlong =
+                            lumaDistance(luma[H], luma[D]) + lumaDistance(luma[H], luma[I5]) +
+                            lumaDistance(luma[F], luma[I4]) + lumaDistance(luma[F], luma[B]) +
+                            4 * lumaDistance(luma[E], luma[I]);
+                        if (edgeAcross < edgeAlong) {
+                            int nearest = lumaDistance(luma[E], luma[F]) <= lumaDistance(luma[E], luma[H]) ? F : H;
+                            out = averagePixels(padded[E], padded[nearest]);
+                        }
+                    }
+                    dst[(2 * y + (corner >> 1)) * dstWidth + 2 * x + (corner & 1)] = out;
+                }
+            }
+        }
+        });
+}
+
+void initPostProcessor(PostProcessor* post, int workerCount) {
+    constexpr size_t maxPixels = static_cast<size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT * MAX_SCALE_FACTOR * MAX_SCALE_FACTOR;
+    post->ghostFrame.assign(SCREEN_WIDTH * SCREEN_HEIGHT, 0);
+    constexpr size_t paddedPixels = static_cast<size_t>(SCREEN_WIDTH * 2 + 2 * XBR_BORDER) * (SCREEN_HEIGHT * 2 + 2 * XBR_BORDER);
+    post->paddedFrame.assign(paddedPixels, 0);
+    post->lumaFrame.assign(paddedPixels, 0);
+    post->stageFrames[0].assign(maxPixels, 0);
+    post->stageFrames[1].assign(maxPixels, 0);
+    post->hasGhostFrame = false;
+    startWorkerPool(&post->pool, workerCount);
+}
+
+void setPostProcessScale(PostProcessor* post, int viewportWidth, int viewportHeight) {
+    int fit = std::min(viewportWidth / SCREEN_WIDTH, viewportHeight / SCREEN_HEIGHT);
+    post->scale = std::clamp(fit, 1, MAX_SCALE_FACTOR);
+}
+
+void cyclePostProcessFilter(PostProcessor* post) {
+    switch (post->filter) {
+    case ScaleFilter::NEAREST:
+        post->filter = ScaleFilter::SCALE2X;
+        break;
+    case ScaleFilter::SCALE2X:
+        post->filter = ScaleFilter::SCALE3X;
+        break;
+    case ScaleFilter::SCALE3X:
+        post->filter = ScaleFilter::XBR2X;
+        break;
+    case ScaleFilter::XBR2X:
+        post->filter = ScaleFilter::NEAREST;
+        break;
+    }
+}
+
+void toggleLCDGhosting(PostProcessor* post) {
+    post->lcdGhosting = !post->lcdGhosting;
+    post->hasGhostFrame = false;
+}
+
+const uint32_t* applyPostProcess(PostProcessor* post, const uint32_t* frame) {
+    const uint32_t* source = frame;
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+
+    if (post->lcdGhosting) {
+        uint32_t* ghost = post->ghostFrame.data();
+        if (!post->hasGhostFrame) {
+            std::memcpy(ghost, frame, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t));
+            post->hasGhostFrame = true;
+        }
+        else {
+            parallelForRows(&post->pool, SCREEN_HEIGHT, [&](int begin, int end) {
+                blendGhostRows(ghost, frame, begin * SCREEN_WIDTH, end * SCREEN_WIDTH);
+                });
+        }
+        source = ghost;
+    }
+
+    int stage = 0;
+    int remaining = post->scale;
+    auto nextStage = [&](int factor) {
+        uint32_t* dst = post->stageFrames[stage].data();
+        stage ^= 1;
+        remaining /= factor;
+        return dst;
+    };
+    auto finishStage = [&](uint32_t* dst, int factor) {
+        source = dst;
+        width *= factor;
+        height *= factor;
+    };
+
+    switch (post->filter) {
+    case ScaleFilter::SCALE2X:
+        while (remaining >= 2) {
+            uint32_t* dst = nextStage(2);
+            scale2x(&post->pool, source, width, height, dst);
+            finishStage(dst, 2);
+        }
+        break;
+    case ScaleFilter::SCALE3X:
+        if (remaining >= 3) {
+            uint32_t* dst = nextStage(3);
+            scale3x(&post->pool, source, width, height, dst);
+            finishStage(dst, 3);
+        }
+        break;
+    case ScaleFilter::XBR2X:
+        if (remaining >= 2) {
+            uint32_t* dst = nextStage(2);
+            xbr2x(&post->pool, source, post->paddedFrame.data(), post->lumaFrame.data(), width, height, dst);
+            finishStage(dst, 2);
+        }
+        break;
+    case ScaleFilter::NEAREST:
+        break;
+    }
+
+    if (remaining > 1) {
+        int factor = remaining;
+        uint32_t* dst = nextStage(factor);
+        scaleNearest(&post->pool, source, width, height, dst, factor);
+        finishStage(dst, factor);
+    }
+
+    int targetWidth = SCREEN_WIDTH * post->scale;
+    int targetHeight = SCREEN_HEIGHT * post->scale;
+    if (width != targetWidth) {
+        uint32_t* dst = post->stageFrames[stage].data();
+        scaleNearestTo(&post->pool, source, width, height, dst, targetWidth, targetHeight);
+        source = dst;
+        width = targetWidth;
+        height = targetHeight;
+    }
+
+    post->outputWidth = width;
+    post->outputHeight = height;
+    return source;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "PPU.hpp"
+#include "WorkerPool.hpp"
+
+#include <cstdint>
+#include <vector>
+
+constexpr int MAX_SCALE_FACTOR = 4;
+constexpr int LCD_GHOSTING_WEIGHT = 0x60;
+constexpr int XBR_BORDER = 2;
+
+enum class ScaleFilter { NEAREST, SCALE2X, SCALE3X, XBR2X };
+
+struct PostProcessor {
+    ScaleFilter filter = ScaleFilter::NEAREST;
+    int scale = 1;
+    bool lcdGhosting = false;
+    bool hasGhostFrame = false;
+
+    std::vector<uint32_t> ghostFrame;
+    std::vector<uint32_t> paddedFrame;
+    std::vector<uint32_t> lumaFrame;
+    std::vector<uint32_t> stageFrames[2];
+
+    int outputWidth = SCREEN_WIDTH;
+    int outputHeight = SCREEN_HEIGHT;
+
+    WorkerPool pool;
+};
+
+void initPostProcessor(PostProcessor* post, int workerCount);
+void setPostProcessScale(PostProcessor* post, int viewportWidth, int viewportHeight);
+void cyclePostProcessFilter(PostProcessor* post);
+void toggleLCDGhosting(PostProcessor* post);
+
+const uint32_t* applyPostProcess(PostProcessor* post, const uint32_t* frame);
@@ -0,0 +1,206 @@
+#include "Recorder.hpp"
+
+#include "APU.hpp"
+#include "PPU.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+constexpr int RECORDER_FRAME_PIXELS = SCREEN_WIDTH * SCREEN_HEIGHT;
+constexpr int RECORDER_CYCLES_PER_FRAME = CYCLES_PER_SCANLINE * TOTAL_SCANLINES;
+constexpr std::streamoff WAV_HEADER_SIZE = 44;
+
+static void initRing(RecorderRing* ring, size_t slotSize, uint32_t capacity) {
+    ring->storage.assign(slotSize * capacity, 0);
+    ring->slotSize = slotSize;
+    ring->capacity = capacity;
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+}
+
+static bool pushSlot(RecorderRing* ring, const void* data) {
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) == ring->capacity) {
+        return false;
+    }
+    std::memcpy(ring->storage.data() + (head % ring->capacity) * ring->slotSize, data, ring->slotSize);
+    ring->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+static const uint8_t* peekSlot(RecorderRing* ring) {
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail == ring->head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return ring->storage.data() + (tail % ring->capacity) * ring->slotSize;
+}
+
+static void popSlot(RecorderRing* ring) {
+    ring->tail.store(ring->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+static void writeLE(std::ofstream& file, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        file.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void writeWavHeader(std::ofstream& file, uint32_t sampleRate, uint32_t dataBytes) {
+    constexpr int channels = 2;
+    constexpr int bytesPerSample = sizeof(float);
+    file.write("RIFF", 4);
+    writeLE(file, static_cast<uint32_t>(std::min<uint64_t>(uint64_t(dataBytes) + WAV_HEADER_SIZE - 8, UINT32_MAX)), 4);
+    file.write("WAVEfmt ", 8);
+    writeLE(file, 16, 4);
+    writeLE(file, 3, 2);
+    writeLE(file, channels, 2);
+    writeLE(file, sampleRate, 4);
+    writeLE(file, sampleRate * channels * bytesPerSample, 4);
+    writeLE(file, channels * bytesPerSample, 2);
+    writeLE(file, 8 * bytesPerSample, 2);
+    file.write("data", 4);
+    writeLE(file, dataBytes, 4);
+}
+
+static void writeVideoFrame(Recorder* recorder, const uint8_t* slot) {
+    const uint32_t* frame = reinterpret_cast<const uint32_t*>(slot);
+    for (int i = 0; i < RECORDER_FRAME_PIXELS; i++) {
+        uint32_t r = (frame[i] >> 16) & 0xFF;
+        uint32_t g = (frame[i] >> 8) & 0xFF;
+        uint32_t b = frame[i] & 0xFF;
+        recorder->lumaFrame[i] = static_cast<uint8_t>((77 * r + 150 * g + 29 * b) >> 8);
+    }
+    recorder->videoFile.write("FRAME\n", 6);
+    recorder->videoFile.write(reinterpret_cast<const char*>(recorder->lumaFrame.data()), RECORDER_FRAME_PIXELS);
+}
+
+static void finalizeRecording(Recorder* recorder) {
+    recorder->videoFile.close();
+
+    recorder->audioFile.seekp(0, std::ios::beg);
+    writeWavHeader(recorder->audioFile, recorder->audioSampleRate, static_cast<uint32_t>(std::min<uint64_t>(recorder->audioBytesWritten, UINT32_MAX)));
+    recorder->audioFile.close();
+
+    uint32_t droppedFrames = recorder->droppedVideoFrames.load(std::memory_order_relaxed);
+    uint32_t droppedBlocks = recorder->droppedAudioBlocks.load(std::memory_order_relaxed);
+    if (droppedFrames || droppedBlocks) {
+        std::cerr << "Enregistrement : " << droppedFrames << " images et " << droppedBlocks
+            << " blocs audio perdus (disque trop lent)" << std::endl;
+    }
+    std::cout << "Enregistrement termin" << std::endl;
+}
+
+static void writerLoop(Recorder* recorder) {
+    while (true) {
+        bool wroteSomething = false;
+
+        while (const uint8_t* slot = peekSlot(&recorder->videoRing)) {
+            writeVideoFrame(recorder, slot);
+            popSlot(&recorder->videoRing);
+            wroteSomething = true;
+        }
+
+        while (const uint8_t* slot = peekSlot(&recorder->audioRing)) {
+            recorder->audioFile.write(reinterpret_cast<const char*>(slot), recorder->audioRing.slotSize);
+            recorder->audioBytesWritten += recorder->audioRing.slotSize;
+            popSlot(&recorder->audioRing);
+            wroteSomething = true;
+        }
+
+        if (wroteSomething) continue;
+
+        if (recorder->stopRequested.load(std::memory_order_acquire)) {
+            if (!peekSlot(&recorder->videoRing) && !peekSlot(&recorder->audioRing)) {
+                finalizeRecording(recorder);
+                return;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(recorder->mutex);
+        recorder->wakeCondition.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+Recorder::~Recorder() {
+    stopRecording(this);
+    if (writerThread.joinable()) writerThread.join();
+}
+
+void initRecorder(Recorder* recorder, uint32_t audioSampleRate) {
+    recorder->audioSampleRate = audioSampleRate;
+    initRing(&recorder->videoRing, RECORDER_FRAME_PIXELS * sizeof(uint32_t), RECORDER_VIDEO_SLOTS);
+    initRing(&recorder->audioRing, APUConstants::SAMPLE_BUF_LEN * sizeof(float), RECORDER_AUDIO_SLOTS);
+    recorder->lumaFrame.assign(RECORDER_FRAME_PIXELS, 0);
+}
+
+std::string generateRecordingBasename() {
+    std::time_t t = std::time(nullptr);
+    std::tm tm;
+    localtime_s(&tm, &t);
+    char buffer[100];
+    std::strftime(buffer, sizeof(buffer), "Enregistrement_%d-%m-%Y_%H-%M-%S", &tm);
+    return std::string(buffer);
+}
+
+bool startRecording(Recorder* recorder, const std::string& basename) {
+    if (recorder->active.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (recorder->writerThread.joinable()) {
+        recorder->writerThread.join();
+    }
+
+    recorder->videoFile.open(basename + ".y4m", std::ios::binary | std::ios::trunc);
+    recorder->audioFile.open(basename + ".wav", std::ios::binary | std::ios::trunc);
+    if (!recorder->videoFile.is_open() || !recorder->audioFile.is_open()) {
+        std::cerr << "Impossible de crer les fichiers d'enregistrement: " << basename << std::endl;
+        recorder->videoFile.close();
+        recorder->audioFile.close();
+        return false;
+    }
+
+    recorder->videoFile << "YUV4MPEG2 W" << SCREEN_WIDTH << " H" << SCREEN_HEIGHT
+        << " F" << APUConstants::BASE_FREQUENCY << ":" << RECORDER_CYCLES_PER_FRAME
+        << " Ip A1:1 Cmono XCOLORRANGE=FULL\n";
+    writeWavHeader(recorder->audioFile, recorder->audioSampleRate, 0);
+    recorder->audioBytesWritten = 0;
+
+    initRing(&recorder->videoRing, recorder->videoRing.slotSize, recorder->videoRing.capacity);
+    initRing(&recorder->audioRing, recorder->audioRing.slotSize, recorder->audioRing.capacity);
+    recorder->droppedVideoFrames.store(0, std::memory_order_relaxed);
+    recorder->droppedAudioBlocks.store(0, std::memory_order_relaxed);
+    recorder->stopRequested.store(false, std::memory_order_relaxed);
+
+    recorder->writerThread = std::thread(writerLoop, recorder);
+    recorder->active.store(true, std::memory_order_release);
+
+    std::cout << "Enregistrement dmarr -> " << basename << ".y4m / .wav" << std::endl;
+    return true;
+}
+
+void stopRecording(Recorder* recorder) {
+    if (!recorder->active.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    recorder->stopRequested.store(true, std::memory_order_release);
+    recorder->wakeCondition.notify_one();
+}
+
+void recordVideoFrame(Recorder* recorder, const uint32_t* frame) {
+    if (!recorder->active.load(std::memory_order_relaxed)) return;
+    if (!pushSlot(&recorder->videoRing, frame)) {
+        recorder->droppedVideoFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void recordAudioBlock(Recorder* recorder, const float* samples) {
+    if (!recorder->active.load(std::memory_order_relaxed)) return;
+    if (!pushSlot(&recorder->audioRing, samples)) {
+        recorder->droppedAudioBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
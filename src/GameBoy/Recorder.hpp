@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr uint32_t RECORDER_VIDEO_SLOTS = 64;
+constexpr uint32_t RECORDER_AUDIO_SLOTS = 2048;
+
+struct RecorderRing {
+    std::vector<uint8_t> storage;
+    size_t slotSize = 0;
+    uint32_t capacity = 0;
+    std::atomic<uint32_t> head = 0;
+    std::atomic<uint32_t> tail = 0;
+};
+
+struct Recorder {
+    RecorderRing videoRing;
+    RecorderRing audioRing;
+
+    std::thread writerThread;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> active = false;
+    std::atomic<bool> stopRequested = false;
+
+    std::ofstream videoFile;
+    std::ofstream audioFile;
+    uint32_t audioSampleRate = 0;
+    uint64_t audioBytesWritten = 0;
+    std::vector<uint8_t> lumaFrame;
+
+    std::atomic<uint32_t> droppedVideoFrames = 0;
+    std::atomic<uint32_t> droppedAudioBlocks = 0;
+
+    ~Recorder();
+};
+
+void initRecorder(Recorder* recorder, uint32_t audioSampleRate);
+void writeWavHeader(std::ofstream& file, uint32_t sampleRate, uint32_t dataBytes);
+std::string generateRecordingBasename();
+
+bool startRecording(Recorder* recorder, const std::string& basename);
+void stopRecording(Recorder* recorder);
+
+void recordVideoFrame(Recorder* recorder, const uint32_t* frame);
+void recordAudioBlock(Recorder* recorder, const float* samples);
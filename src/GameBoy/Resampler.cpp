@@ -0,0 +1,174 @@
+#include "Resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RESAMPLER_SSE2 1
+#endif
+
+constexpr double RESAMPLER_PI = 3.14159265358979323846;
+
+static double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+static void designPhase(float* out, double fraction, double cutoff) {
+    constexpr double half = RESAMPLER_TAPS / 2;
+    double norm = besselI0(RESAMPLER_KAISER_BETA);
+    double values[RESAMPLER_TAPS];
+    double sum = 0.0;
+    for (int tap = 0; tap < RESAMPLER_TAPS; tap++) {
+        double x = tap - (half - 1) - fraction;
+        double sinc = x == 0.0 ? 1.0 : std::sin(2.0 * RESAMPLER_PI * cutoff * x) / (2.0 * RESAMPLER_PI * cutoff * x);
+        double ratio = x / half;
+        double window = std::abs(ratio) < 1.0 ? besselI0(RESAMPLER_KAISER_BETA * std::sqrt(1.0 - ratio * ratio)) / norm : 0.0;
+        values[tap] = sinc * window;
+        sum += values[tap];
+    }
+    for (int tap = 0; tap < RESAMPLER_TAPS; tap++) {
+        out[tap] = static_cast<float>(values[tap] / sum);
+    }
+}
+
+static const ResamplerKernel* resamplerKernel(double cutoff) {
+    static std::mutex mutex;
+    static std::map<double, std::unique_ptr<ResamplerKernel>> kernels;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<ResamplerKernel>& kernel = kernels[cutoff];
+    if (kernel) return kernel.get();
+
+    kernel = std::make_unique<ResamplerKernel>();
+    float next[RESAMPLER_TAPS];
+    designPhase(kernel->coefficients.data(), 0.0, cutoff);
+    for (int phase = 0; phase < RESAMPLER_PHASE_COUNT; phase++) {
+        float* row = &kernel->coefficients[phase * RESAMPLER_TAPS];
+        float* slope = &kernel->slopes[phase * RESAMPLER_TAPS];
+        float* following = phase + 1 < RESAMPLER_PHASE_COUNT ? row + RESAMPLER_TAPS : next;
+        designPhase(following, static_cast<double>(phase + 1) / RESAMPLER_PHASE_COUNT, cutoff);
+        for (int tap = 0; tap < RESAMPLER_TAPS; tap++) {
+            slope[tap] = following[tap] - row[tap];
+        }
+    }
+    return kernel.get();
+}
+
+void clearResampler(Resampler* resampler) {
+    resampler->left.fill(0.0f);
+    resampler->right.fill(0.0f);
+    resampler->buffered = 0;
+    resampler->position = 0;
+}
+
+void initResampler(Resampler* resampler, double inputRate, double outputRate) {
+    double cutoff = 0.5 * std::min(1.0, outputRate / inputRate) * RESAMPLER_CUTOFF;
+    resampler->kernel = resamplerKernel(cutoff);
+    resampler->vectorized = isResamplerVectorized();
+    clearResampler(resampler);
+    setResamplerRatio(resampler, inputRate, outputRate);
+}
+
+void setResamplerRatio(Resampler* resampler, double inputRate, double outputRate) {
+    resampler->step = static_cast<uint64_t>(inputRate / outputRate * static_cast<double>(1ull << RESAMPLER_POSITION_BITS) + 0.5);
+}
+
+int resamplerInputNeeded(const Resampler* resampler, int outputFrames) {
+    if (outputFrames <= 0) return 0;
+    uint64_t last = resampler->position + static_cast<uint64_t>(outputFrames - 1) * resampler->step;
+    int required = static_cast<int>(last >> RESAMPLER_POSITION_BITS) + RESAMPLER_TAPS;
+    return std::max(0, required - resampler->buffered);
+}
+
+int resamplerOutputAvailable(const Resampler* resampler, int inputFrames) {
+    int last = resampler->buffered + inputFrames - RESAMPLER_TAPS;
+    if (last < 0) return 0;
+    uint64_t limit = (static_cast<uint64_t>(last) << RESAMPLER_POSITION_BITS) | ((1ull << RESAMPLER_POSITION_BITS) - 1);
+    if (resampler->position > limit) return 0;
+    return static_cast<int>((limit - resampler->position) / resampler->step) + 1;
+}
+
+static void filterFrameScalar(const float* kernel, const float* slope, float blend, const float* left, const float* right, float* out) {
+    float leftSum = 0.0f;
+    float rightSum = 0.0f;
+    for (int tap = 0; tap < RESAMPLER_TAPS; tap++) {
+        float coefficient = kernel[tap] + slope[tap] * blend;
+        leftSum += coefficient * left[tap];
+        rightSum += coefficient * right[tap];
+    }
+    out[0] = leftSum;
+    out[1] = rightSum;
+}
+
+#ifdef RESAMPLER_SSE2
+static void filterFrameSSE2(const float* kernel, const float* slope, float blend, const float* left, const float* right, float* out) {
+    __m128 weight = _mm_set1_ps(blend);
+    __m128 leftSum = _mm_setzero_ps();
+    __m128 rightSum = _mm_setzero_ps();
+    for (int tap = 0; tap < RESAMPLER_TAPS; tap += 4) {
+        __m128 coefficient = _mm_add_ps(_mm_load_ps(kernel + tap), _mm_mul_ps(_mm_load_ps(slope + tap), weight));
+        leftSum = _mm_add_ps(leftSum, _mm_mul_ps(coefficient, _mm_loadu_ps(left + tap)));
+        rightSum = _mm_add_ps(rightSum, _mm_mul_ps(coefficient, _mm_loadu_ps(right + tap)));
+    }
+    __m128 low = _mm_unpacklo_ps(leftSum, rightSum);
+    __m128 high = _mm_unpackhi_ps(leftSum, rightSum);
+    __m128 pairs = _mm_add_ps(low, high);
+    __m128 total = _mm_add_ps(pairs, _mm_movehl_ps(pairs, pairs));
+    _mm_storel_pi(reinterpret_cast<__m64*>(out), total);
+}
+#endif
+
+template <void (*FilterFrame)(const float*, const float*, float, const float*, const float*, float*)>
+static void filterFrames(Resampler* resampler, float* out, int outputFrames) {
+    constexpr int fractionBits = RESAMPLER_POSITION_BITS - RESAMPLER_PHASE_BITS;
+    constexpr float blendScale = 1.0f / static_cast<float>(1u << fractionBits);
+    for (int frame = 0; frame < outputFrames; frame++) {
+        size_t index = static_cast<size_t>(resampler->position >> RESAMPLER_POSITION_BITS);
+        uint32_t fraction = static_cast<uint32_t>(resampler->position);
+        int phase = static_cast<int>(fraction >> fractionBits);
+        float blend = static_cast<float>(fraction & ((1u << fractionBits) - 1)) * blendScale;
+        FilterFrame(&resampler->kernel->coefficients[phase * RESAMPLER_TAPS], &resampler->kernel->slopes[phase * RESAMPLER_TAPS], blend,
+            &resampler->left[index], &resampler->right[index], out + frame * 2);
+        resampler->position += resampler->step;
+    }
+}
+
+bool isResamplerVectorized() {
+#ifdef RESAMPLER_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void resampleFrames(Resampler* resampler, int inputFrames, float* out, int outputFrames) {
+    resampler->buffered = std::min(resampler->buffered + inputFrames, RESAMPLER_HISTORY);
+
+#ifdef RESAMPLER_SSE2
+    if (resampler->vectorized) {
+        filterFrames<filterFrameSSE2>(resampler, out, outputFrames);
+    }
+    else {
+        filterFrames<filterFrameScalar>(resampler, out, outputFrames);
+    }
+#else
+    filterFrames<filterFrameScalar>(resampler, out, outputFrames);
+#endif
+
+    int consumed = std::min(static_cast<int>(resampler->position >> RESAMPLER_POSITION_BITS), resampler->buffered);
+    int remaining = resampler->buffered - consumed;
+    std::memmove(resampler->left.data(), resampler->left.data() + consumed, remaining * sizeof(float));
+    std::memmove(resampler->right.data(), resampler->right.data() + consumed, remaining * sizeof(float));
+    resampler->buffered = remaining;
+    resampler->position -= static_cast<uint64_t>(consumed) << RESAMPLER_POSITION_BITS;
+}
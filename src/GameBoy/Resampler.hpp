@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+constexpr int RESAMPLER_PHASE_BITS = 8;
+constexpr int RESAMPLER_PHASE_COUNT = 1 << RESAMPLER_PHASE_BITS;
+constexpr int RESAMPLER_TAPS = 48;
+constexpr int RESAMPLER_HISTORY = 4096;
+constexpr int RESAMPLER_POSITION_BITS = 32;
+constexpr double RESAMPLER_CUTOFF = 0.85;
+constexpr double RESAMPLER_KAISER_BETA = 8.6;
+
+struct ResamplerKernel {
+    alignas(16) std::array<float, RESAMPLER_PHASE_COUNT * RESAMPLER_TAPS> coefficients;
+    alignas(16) std::array<float, RESAMPLER_PHASE_COUNT * RESAMPLER_TAPS> slopes;
+};
+
+struct Resampler {
+    const ResamplerKernel* kernel;
+    alignas(16) std::array<float, RESAMPLER_HISTORY> left;
+    alignas(16) std::array<float, RESAMPLER_HISTORY> right;
+    int buffered;
+    uint64_t position;
+    uint64_t step;
+    bool vectorized;
+};
+
+bool isResamplerVectorized();
+
+void clearResampler(Resampler* resampler);
+void initResampler(Resampler* resampler, double inputRate, double outputRate);
+void setResamplerRatio(Resampler* resampler, double inputRate, double outputRate);
+
+int resamplerInputNeeded(const Resampler* resampler, int outputFrames);
+int resamplerOutputAvailable(const Resampler* resampler, int inputFrames);
+void resampleFrames(Resampler* resampler, int inputFrames, float* out, int outputFrames);
@@ -0,0 +1,311 @@
+#include "RomHash.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ROM_HASH_SSE2 1
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define ROM_HASH_X64 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ROM_HASH_TARGET(features)
+#else
+#include <cpuid.h>
+#define ROM_HASH_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+constexpr uint32_t CRC32_POLYNOMIAL = 0xEDB88320;
+constexpr size_t SHA1_BLOCK_SIZE = 64;
+
+using CRC32Tables = std::array<std::array<uint32_t, 256>, 8>;
+using SHA1Compress = void (*)(uint32_t* state, const uint8_t* blocks, size_t count);
+
+struct HashFeatures {
+    bool clmul = false;
+    bool sha = false;
+};
+
+static HashFeatures detectHashFeatures() {
+    HashFeatures features;
+#ifdef ROM_HASH_X64
+    unsigned int leaf1[4] = {};
+    unsigned int leaf7[4] = {};
+#ifdef _MSC_VER
+    __cpuid(reinterpret_cast<int*>(leaf1), 1);
+    __cpuidex(reinterpret_cast<int*>(leaf7), 7, 0);
+#else
+    __get_cpuid(1, &leaf1[0], &leaf1[1], &leaf1[2], &leaf1[3]);
+    __get_cpuid_count(7, 0, &leaf7[0], &leaf7[1], &leaf7[2], &leaf7[3]);
+#endif
+    bool ssse3 = leaf1[2] & (1u << 9);
+    bool sse41 = leaf1[2] & (1u << 19);
+    features.clmul = (leaf1[2] & (1u << 1)) && sse41;
+    features.sha = (leaf7[1] & (1u << 29)) && ssse3 && sse41;
+#endif
+    return features;
+}
+
+static const HashFeatures& getHashFeatures() {
+    static const HashFeatures features = detectHashFeatures();
+    return features;
+}
+
+static const CRC32Tables& getCRC32Tables() {
+    static const CRC32Tables tables = []() {
+        CRC32Tables t = {};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0u - (crc & 1)));
+            }
+            t[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int slice = 1; slice < 8; slice++) {
+                t[slice][i] = (t[slice - 1][i] >> 8) ^ t[0][t[slice - 1][i] & 0xFF];
+            }
+        }
+        return t;
+        }();
+    return tables;
+}
+
+static uint32_t updateCRC32Tables(uint32_t crc, const uint8_t* data, size_t size) {
+    const CRC32Tables& t = getCRC32Tables();
+    while (size >= 8) {
+        uint32_t low, high;
+        std::memcpy(&low, data, 4);
+        std::memcpy(&high, data + 4, 4);
+        low ^= crc;
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+            t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef ROM_HASH_X64
+ROM_HASH_TARGET("pclmul,sse4.1")
+static uint32_t updateCRC32CLMUL(uint32_t crc, const uint8_t* data, size_t size) {
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    data += 64;
+    size -= 64;
+
+    while (size >= 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+        data += 64;
+        size -= 64;
+    }
+
+    __m128i folded[3] = { x2, x3, x4 };
+    for (__m128i next : folded) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+    }
+    while (size >= 16) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+        data += 16;
+        size -= 16;
+    }
+
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+#endif
+
+uint32_t computeCRC32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+#ifdef ROM_HASH_X64
+    if (getHashFeatures().clmul && size >= 64) {
+        size_t folded = size & ~static_cast<size_t>(15);
+        crc = updateCRC32CLMUL(crc, data, folded);
+        data += folded;
+        size -= folded;
+    }
+#endif
+    return ~updateCRC32Tables(crc, data, size);
+}
+
+static inline uint32_t rotateLeft(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static void compressSHA1Scalar(uint32_t* state, const uint8_t* blocks, size_t count) {
+    for (; count > 0; count--, blocks += SHA1_BLOCK_SIZE) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t(blocks[i * 4]) << 24) | (uint32_t(blocks[i * 4 + 1]) << 16) |
+                (uint32_t(blocks[i * 4 + 2]) << 8) | uint32_t(blocks[i * 4 + 3]);
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+            uint32_t t = rotateLeft(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotateLeft(b, 30);
+            b = a;
+            a = t;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
+
+#ifdef ROM_HASH_X64
+ROM_HASH_TARGET("sha,ssse3,sse4.1")
+static void compressSHA1NI(uint32_t* state, const uint8_t* blocks, size_t count) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607ll, 0x08090a0b0c0d0e0fll);
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+    __m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+    for (; count > 0; count--, blocks += SHA1_BLOCK_SIZE) {
+        __m128i abcdSave = abcd;
+        __m128i eSave = e0;
+
+        __m128i w[20];
+        for (int i = 0; i < 4; i++) {
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + i * 16)), byteSwap);
+        }
+        for (int i = 4; i < 20; i++) {
+            w[i] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w[i - 4], w[i - 3]), w[i - 2]), w[i - 1]);
+        }
+
+        __m128i e = _mm_add_epi32(e0, w[0]);
+        __m128i previous = abcd;
+        for (int i = 0; i < 20; i++) {
+            if (i > 0) {
+                e = _mm_sha1nexte_epu32(previous, w[i]);
+            }
+            previous = abcd;
+            switch (i / 5) {
+            case 0: abcd = _mm_sha1rnds4_epu32(abcd, e, 0); break;
+            case 1: abcd = _mm_sha1rnds4_epu32(abcd, e, 1); break;
+            case 2: abcd = _mm_sha1rnds4_epu32(abcd, e, 2); break;
+            default: abcd = _mm_sha1rnds4_epu32(abcd, e, 3); break;
+            }
+        }
+
+        e0 = _mm_sha1nexte_epu32(previous, eSave);
+        abcd = _mm_add_epi32(abcd, abcdSave);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+#endif
+
+void computeSHA1(const uint8_t* data, size_t size, uint8_t digest[SHA1_DIGEST_SIZE]) {
+    SHA1Compress compress = compressSHA1Scalar;
+#ifdef ROM_HASH_X64
+    if (getHashFeatures().sha) {
+        compress = compressSHA1NI;
+    }
+#endif
+
+    uint32_t state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    size_t fullBlocks = size / SHA1_BLOCK_SIZE;
+    compress(state, data, fullBlocks);
+
+    uint8_t tail[SHA1_BLOCK_SIZE * 2] = {};
+    size_t remaining = size - fullBlocks * SHA1_BLOCK_SIZE;
+    std::memcpy(tail, data + fullBlocks * SHA1_BLOCK_SIZE, remaining);
+    tail[remaining] = 0x80;
+    size_t tailBlocks = remaining + 9 > SHA1_BLOCK_SIZE ? 2 : 1;
+    uint64_t bits = static_cast<uint64_t>(size) * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[tailBlocks * SHA1_BLOCK_SIZE - 1 - i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+    compress(state, tail, tailBlocks);
+
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+    }
+}
+
+uint8_t computeHeaderChecksum(const uint8_t* rom) {
+    uint8_t checksum = 0;
+    for (uint16_t address = ROM_HEADER_CHECKSUM_START; address < ROM_HEADER_CHECKSUM; address++) {
+        checksum = checksum - rom[address] - 1;
+    }
+    return checksum;
+}
+
+uint16_t computeGlobalChecksum(const uint8_t* rom, size_t size) {
+    uint64_t sum = 0;
+    size_t i = 0;
+#ifdef ROM_HASH_SSE2
+    __m128i zero = _mm_setzero_si128();
+    __m128i total = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        total = _mm_add_epi64(total, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rom + i)), zero));
+    }
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), total);
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < size; i++) {
+        sum += rom[i];
+    }
+    if (size >= ROM_HEADER_END) {
+        sum -= rom[ROM_GLOBAL_CHECKSUM] + rom[ROM_GLOBAL_CHECKSUM + 1];
+    }
+    return static_cast<uint16_t>(sum);
+}
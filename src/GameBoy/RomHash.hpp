@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr size_t SHA1_DIGEST_SIZE = 20;
+
+constexpr uint16_t ROM_HEADER_CHECKSUM_START = 0x0134;
+constexpr uint16_t ROM_HEADER_CHECKSUM = 0x014D;
+constexpr uint16_t ROM_GLOBAL_CHECKSUM = 0x014E;
+constexpr uint16_t ROM_HEADER_END = 0x0150;
+
+uint32_t computeCRC32(const uint8_t* data, size_t size);
+void computeSHA1(const uint8_t* data, size_t size, uint8_t digest[SHA1_DIGEST_SIZE]);
+
+uint8_t computeHeaderChecksum(const uint8_t* rom);
+uint16_t computeGlobalChecksum(const uint8_t* rom, size_t size);
@@ -0,0 +1,276 @@
+#include "RomImage.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+struct HandleDeleter {
+    void operator()(HANDLE handle) const {
+        if (handle && handle != INVALID_HANDLE_VALUE) {
+            CloseHandle(handle);
+        }
+    }
+};
+
+using unique_handle = std::unique_ptr<std::remove_pointer<HANDLE>::type, HandleDeleter>;
+
+const uint8_t* mapROMFile(const char* fileName, size_t* fileSize) {
+    unique_handle hFile(CreateFileA(
+        fileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr));
+    if (hFile.get() == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER liSize;
+    if (!GetFileSizeEx(hFile.get(), &liSize) || liSize.QuadPart == 0) {
+        return nullptr;
+    }
+
+    unique_handle hMap(CreateFileMappingA(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    if (!hMap) {
+        return nullptr;
+    }
+
+    LPVOID mappedView = MapViewOfFile(hMap.get(), FILE_MAP_READ, 0, 0, 0);
+    *fileSize = static_cast<size_t>(liSize.QuadPart);
+    return reinterpret_cast<const uint8_t*>(mappedView);
+}
+
+void unmapROMFile(const uint8_t* data, size_t) {
+    UnmapViewOfFile(data);
+}
+#else
+const uint8_t* mapROMFile(const char* fileName, size_t* fileSize) {
+    int fd = open(fileName, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    void* mappedView = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        mappedView = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mappedView == MAP_FAILED) {
+        return nullptr;
+    }
+
+    *fileSize = static_cast<size_t>(st.st_size);
+    return reinterpret_cast<const uint8_t*>(mappedView);
+}
+
+void unmapROMFile(const uint8_t* data, size_t fileSize) {
+    munmap(const_cast<uint8_t*>(data), fileSize);
+}
+#endif
+
+struct ROMMappingDeleter {
+    size_t fileSize;
+    void operator()(const uint8_t* data) const {
+        unmapROMFile(data, fileSize);
+    }
+};
+
+using unique_rom = std::unique_ptr<const uint8_t, ROMMappingDeleter>;
+
+struct RomImageRegistry {
+    std::mutex mutex;
+    std::unordered_map<std::string, RomImage*> images;
+};
+
+static RomImageRegistry& getRomImageRegistry() {
+    static RomImageRegistry registry;
+    return registry;
+}
+
+static std::string getRomImageKey(const char* fileName) {
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::weakly_canonical(fileName, ec);
+    return ec ? std::string(fileName) : path.string();
+}
+
+static bool parseRomImageHeader(RomImage* image) {
+    const uint8_t* headerData = image->data + 0x0147;
+
+    uint8_t MapperCode = headerData[0];
+    if (MapperCode == 0 || MapperCode == 0x08 || MapperCode == 0x09)
+        image->Mapper = MBC::MBC0;
+    else if (MapperCode >= 0x01 && MapperCode <= 0x03)
+        image->Mapper = MBC::MBC1;
+    else if (MapperCode == 0x05 || MapperCode == 0x06)
+        image->Mapper = MBC::MBC2;
+    else if (MapperCode >= 0x0f && MapperCode <= 0x13)
+        image->Mapper = MBC::MBC3;
+    else if (MapperCode >= 0x19 && MapperCode <= 0x1e)
+        image->Mapper = MBC::MBC5;
+    else {
+        std::cerr << "Mapper non support: " << static_cast<int>(MapperCode) << std::endl;
+        return false;
+    }
+    image->mapperCode = MapperCode;
+
+    switch (MapperCode) {
+    case 0x03:
+    case 0x06:
+    case 0x09:
+    case 0x0d:
+    case 0x0f:
+    case 0x10:
+    case 0x13:
+    case 0x1b:
+    case 0x1e:
+    case 0x22:
+        image->hasBatteryBackup = true;
+        break;
+    default:
+        image->hasBatteryBackup = false;
+        break;
+    }
+    image->hasRTC = MapperCode == 0x0f || MapperCode == 0x10;
+
+    image->romBanks = (headerData[1] <= 8) ? (2 << headerData[1]) : -1;
+    if (image->romBanks == -1) {
+        std::cerr << "Nombre de banques ROM invalide: " << static_cast<int>(headerData[1]) << std::endl;
+        return false;
+    }
+
+    switch (headerData[2]) {
+    case 0:
+    case 1:
+        image->ramBanks = 0;
+        break;
+    case 2:
+        image->ramBanks = 1;
+        break;
+    case 3:
+        image->ramBanks = 4;
+        break;
+    case 4:
+        image->ramBanks = 16;
+        break;
+    case 5:
+        image->ramBanks = 8;
+        break;
+    default:
+        std::cerr << "Nombre de banques RAM invalide: " << static_cast<int>(headerData[2]) << std::endl;
+        return false;
+    }
+
+    if (image->size < static_cast<size_t>(image->romBanks) * ROM_BANK_SIZE) {
+        std::cerr << "Erreur de lecture des donnes ROM." << std::endl;
+        return false;
+    }
+
+    image->headerChecksum = image->data[ROM_HEADER_CHECKSUM];
+    image->headerChecksumValid = computeHeaderChecksum(image->data) == image->headerChecksum;
+    if (!image->headerChecksumValid) {
+        std::cerr << "Checksum d'en-tte incorrect, la ROM est peut-tre corrompue." << std::endl;
+    }
+    return true;
+}
+
+static void adviseRomImage(RomImage* image) {
+#ifndef _WIN32
+    madvise(const_cast<uint8_t*>(image->data), static_cast<size_t>(image->romBanks) * ROM_BANK_SIZE,
+        image->romBanks > 2 ? MADV_RANDOM : MADV_WILLNEED);
+#endif
+    prefetchRomImageBank(image, 0);
+    prefetchRomImageBank(image, 1);
+}
+
+static RomImage* loadRomImage(const char* fileName) {
+    size_t romFileSize = 0;
+    unique_rom romMapping(mapROMFile(fileName, &romFileSize), ROMMappingDeleter{ 0 });
+    if (!romMapping) {
+        std::cerr << "Impossible d'ouvrir le fichier: " << fileName << std::endl;
+        return nullptr;
+    }
+    romMapping.get_deleter().fileSize = romFileSize;
+
+    if (romFileSize < ROM_HEADER_END) {
+        std::cerr << "Erreur de lecture de l'en-tte du fichier." << std::endl;
+        return nullptr;
+    }
+
+    auto image = std::make_unique<RomImage>();
+    image->data = romMapping.get();
+    image->size = romFileSize;
+    if (!parseRomImageHeader(image.get())) {
+        return nullptr;
+    }
+
+    romMapping.release();
+    adviseRomImage(image.get());
+    return image.release();
+}
+
+RomImage* acquireRomImage(const char* fileName) {
+    std::string key = getRomImageKey(fileName);
+
+    RomImageRegistry& registry = getRomImageRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.images.find(key);
+    if (it != registry.images.end()) {
+        it->second->refCount.fetch_add(1, std::memory_order_relaxed);
+        return it->second;
+    }
+
+    RomImage* image = loadRomImage(fileName);
+    if (!image) {
+        return nullptr;
+    }
+    image->path = key;
+    image->refCount.store(1, std::memory_order_relaxed);
+    registry.images.emplace(key, image);
+    return image;
+}
+
+void retainRomImage(RomImage* image) {
+    image->refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void releaseRomImage(RomImage* image) {
+    if (!image) return;
+
+    RomImageRegistry& registry = getRomImageRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (image->refCount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    registry.images.erase(image->path);
+    unmapROMFile(image->data, image->size);
+    delete image;
+}
+
+void computeRomImageChecksums(RomImage* image) {
+    std::call_once(image->checksumsComputed, [image]() {
+        image->globalChecksum = static_cast<uint16_t>((image->data[ROM_GLOBAL_CHECKSUM] << 8) | image->data[ROM_GLOBAL_CHECKSUM + 1]);
+        image->globalChecksumValid = computeGlobalChecksum(image->data, image->size) == image->globalChecksum;
+        image->crc32 = computeCRC32(image->data, image->size);
+        computeSHA1(image->data, image->size, image->sha1);
+        });
+}
+
+void adviseRomImageBank(const RomImage* image, int bank) {
+#ifndef _WIN32
+    madvise(const_cast<uint8_t*>(image->data) + static_cast<size_t>(bank) * ROM_BANK_SIZE, ROM_BANK_SIZE, MADV_WILLNEED);
+#endif
+}
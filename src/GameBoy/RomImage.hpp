@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Cartridge.hpp"
+#include "RomHash.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+struct RomImage {
+    std::string path;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    MBC Mapper = MBC::MBC0;
+    uint8_t mapperCode = 0;
+    bool hasBatteryBackup = false;
+    bool hasRTC = false;
+    int romBanks = 0;
+    int ramBanks = 0;
+
+    uint8_t headerChecksum = 0;
+    bool headerChecksumValid = false;
+
+    std::once_flag checksumsComputed;
+    uint16_t globalChecksum = 0;
+    bool globalChecksumValid = false;
+    uint32_t crc32 = 0;
+    uint8_t sha1[SHA1_DIGEST_SIZE] = {};
+
+    std::atomic<uint64_t> prefetchedRomBanks[MAX_ROM_BANKS / 64] = {};
+    std::atomic<int> refCount = 0;
+};
+
+const uint8_t* mapROMFile(const char* fileName, size_t* fileSize);
+void unmapROMFile(const uint8_t* data, size_t fileSize);
+
+RomImage* acquireRomImage(const char* fileName);
+void retainRomImage(RomImage* image);
+void releaseRomImage(RomImage* image);
+
+void computeRomImageChecksums(RomImage* image);
+
+void adviseRomImageBank(const RomImage* image, int bank);
+
+inline void prefetchRomImageBank(RomImage* image, int bank) {
+    uint64_t bit = 1ull << (bank & 63);
+    std::atomic<uint64_t>& prefetched = image->prefetchedRomBanks[bank >> 6];
+    if (!(prefetched.load(std::memory_order_relaxed) & bit) &&
+        !(prefetched.fetch_or(bit, std::memory_order_relaxed) & bit)) {
+        adviseRomImageBank(image, bank);
+    }
+}
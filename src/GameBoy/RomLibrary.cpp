@@ -0,0 +1,364 @@
+#include "RomLibrary.hpp"
+
+#include "RomImage.hpp"
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+static bool isRomFileName(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".gb" || extension == ".gbc";
+}
+
+static std::string normalizeDirectory(const std::string& directory) {
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::weakly_canonical(directory, ec);
+    if (ec) {
+        path = std::filesystem::absolute(directory);
+    }
+    std::string normalized = path.lexically_normal().string();
+    if (!normalized.empty() && normalized.back() != std::filesystem::path::preferred_separator) {
+        normalized += std::filesystem::path::preferred_separator;
+    }
+    return normalized;
+}
+
+static bool isInDirectories(const std::string& path, const std::vector<std::string>& directories) {
+    for (const std::string& directory : directories) {
+        if (path.compare(0, directory.size(), directory) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<RomLibraryEntry> listRomFiles(const std::string& directory) {
+    std::vector<RomLibraryEntry> files;
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(directory, std::filesystem::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code entryError;
+        if (!it->is_regular_file(entryError) || !isRomFileName(it->path())) {
+            continue;
+        }
+
+        RomLibraryEntry entry;
+        entry.path = it->path().lexically_normal().string();
+        entry.fileSize = it->file_size(entryError);
+        entry.modifiedTime = static_cast<int64_t>(it->last_write_time(entryError).time_since_epoch().count());
+        if (!entryError) {
+            files.push_back(std::move(entry));
+        }
+    }
+    if (ec) {
+        std::cerr << "Erreur lors du parcours du dossier " << directory << ": " << ec.message() << std::endl;
+    }
+    return files;
+}
+
+static void parseRomHeader(RomLibraryEntry* entry, const uint8_t* rom) {
+    entry->headerValid = true;
+    entry->cgbFlag = rom[ROM_CGB_FLAG];
+    entry->sgbFlag = rom[ROM_SGB_FLAG];
+    entry->cartridgeType = rom[ROM_CARTRIDGE_TYPE];
+    entry->romSizeCode = rom[ROM_SIZE_CODE];
+    entry->ramSizeCode = rom[ROM_RAM_SIZE_CODE];
+
+    size_t titleLength = (entry->cgbFlag & 0x80) ? ROM_TITLE_LENGTH - 1 : ROM_TITLE_LENGTH;
+    entry->title.clear();
+    for (size_t i = 0; i < titleLength; i++) {
+        char c = static_cast<char>(rom[ROM_TITLE_ADDRESS + i]);
+        if (c == '\0') break;
+        entry->title += (c >= 0x20 && c < 0x7F) ? c : '?';
+    }
+
+    entry->headerChecksum = rom[ROM_HEADER_CHECKSUM];
+    entry->headerChecksumValid = computeHeaderChecksum(rom) == entry->headerChecksum;
+    entry->globalChecksum = static_cast<uint16_t>((rom[ROM_GLOBAL_CHECKSUM] << 8) | rom[ROM_GLOBAL_CHECKSUM + 1]);
+}
+
+static void analyzeRomFile(RomLibraryEntry* entry) {
+    size_t fileSize = 0;
+    const uint8_t* rom = mapROMFile(entry->path.c_str(), &fileSize);
+    if (!rom) {
+        std::cerr << "Impossible d'ouvrir le fichier ROM: " << entry->path << std::endl;
+        entry->headerValid = false;
+        return;
+    }
+
+    entry->fileSize = fileSize;
+    entry->headerValid = false;
+    if (fileSize >= ROM_HEADER_END) {
+        parseRomHeader(entry, rom);
+        entry->globalChecksumValid = computeGlobalChecksum(rom, fileSize) == entry->globalChecksum;
+    }
+    entry->crc32 = computeCRC32(rom, fileSize);
+    computeSHA1(rom, fileSize, entry->sha1);
+
+    unmapROMFile(rom, fileSize);
+}
+
+template <typename T>
+static void writeIndexValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool readIndexValue(std::ifstream& file, T* value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(value), sizeof(T)));
+}
+
+static void writeIndexString(std::ofstream& file, const std::string& value) {
+    writeIndexValue(file, static_cast<uint32_t>(value.size()));
+    file.write(value.data(), value.size());
+}
+
+static bool readIndexString(std::ifstream& file, std::string* value) {
+    uint32_t length;
+    if (!readIndexValue(file, &length) || length > 0xFFFF) {
+        return false;
+    }
+    value->resize(length);
+    return static_cast<bool>(file.read(value->data(), length));
+}
+
+static bool readIndexEntry(std::ifstream& file, RomLibraryEntry* entry) {
+    uint8_t flags;
+    if (!readIndexString(file, &entry->path) ||
+        !readIndexValue(file, &entry->modifiedTime) ||
+        !readIndexValue(file, &entry->fileSize) ||
+        !readIndexValue(file, &flags) ||
+        !readIndexString(file, &entry->title) ||
+        !readIndexValue(file, &entry->cgbFlag) ||
+        !readIndexValue(file, &entry->sgbFlag) ||
+        !readIndexValue(file, &entry->cartridgeType) ||
+        !readIndexValue(file, &entry->romSizeCode) ||
+        !readIndexValue(file, &entry->ramSizeCode) ||
+        !readIndexValue(file, &entry->headerChecksum) ||
+        !readIndexValue(file, &entry->globalChecksum) ||
+        !readIndexValue(file, &entry->crc32) ||
+        !file.read(reinterpret_cast<char*>(entry->sha1), SHA1_DIGEST_SIZE)) {
+        return false;
+    }
+    entry->headerValid = flags & 0x01;
+    entry->headerChecksumValid = flags & 0x02;
+    entry->globalChecksumValid = flags & 0x04;
+    return true;
+}
+
+static void writeIndexEntry(std::ofstream& file, const RomLibraryEntry& entry) {
+    uint8_t flags = (entry.headerValid ? 0x01 : 0) | (entry.headerChecksumValid ? 0x02 : 0) | (entry.globalChecksumValid ? 0x04 : 0);
+    writeIndexString(file, entry.path);
+    writeIndexValue(file, entry.modifiedTime);
+    writeIndexValue(file, entry.fileSize);
+    writeIndexValue(file, flags);
+    writeIndexString(file, entry.title);
+    writeIndexValue(file, entry.cgbFlag);
+    writeIndexValue(file, entry.sgbFlag);
+    writeIndexValue(file, entry.cartridgeType);
+    writeIndexValue(file, entry.romSizeCode);
+    writeIndexValue(file, entry.ramSizeCode);
+    writeIndexValue(file, entry.headerChecksum);
+    writeIndexValue(file, entry.globalChecksum);
+    writeIndexValue(file, entry.crc32);
+    file.write(reinterpret_cast<const char*>(entry.sha1), SHA1_DIGEST_SIZE);
+}
+
+bool isRomLibraryDirectory(const std::string& path) {
+    std::error_code ec;
+    return std::filesystem::is_directory(path, ec);
+}
+
+bool loadRomLibrary(RomLibrary* library, const std::string& indexPath) {
+    library->indexPath = indexPath;
+    library->entries.clear();
+
+    std::ifstream file(indexPath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(ROM_LIBRARY_MAGIC)];
+    uint8_t version;
+    uint32_t count;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, ROM_LIBRARY_MAGIC, sizeof(magic)) != 0 ||
+        !readIndexValue(file, &version) || version != ROM_LIBRARY_VERSION ||
+        !readIndexValue(file, &count)) {
+        std::cerr << "Index de la bibliothque invalide ou obsolte, il sera reconstruit: " << indexPath << std::endl;
+        return false;
+    }
+
+    library->entries.resize(count);
+    for (RomLibraryEntry& entry : library->entries) {
+        if (!readIndexEntry(file, &entry)) {
+            std::cerr << "Index de la bibliothque tronqu, il sera reconstruit: " << indexPath << std::endl;
+            library->entries.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool saveRomLibrary(const RomLibrary* library) {
+    std::string tempPath = library->indexPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Impossible de crer le fichier: " << tempPath << std::endl;
+            return false;
+        }
+
+        file.write(ROM_LIBRARY_MAGIC, sizeof(ROM_LIBRARY_MAGIC));
+        writeIndexValue(file, ROM_LIBRARY_VERSION);
+        writeIndexValue(file, static_cast<uint32_t>(library->entries.size()));
+        for (const RomLibraryEntry& entry : library->entries) {
+            writeIndexEntry(file, entry);
+        }
+        if (!file.good()) {
+            std::cerr << "Erreur lors de l'criture de l'index de la bibliothque: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, library->indexPath, ec);
+    if (ec) {
+        std::cerr << "Erreur lors du remplacement de l'index de la bibliothque: " << ec.message() << std::endl;
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+RomLibraryScanResult scanRomLibrary(RomLibrary* library, const std::vector<std::string>& directories) {
+    RomLibraryScanResult result = {};
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::string> roots;
+    for (const std::string& directory : directories) {
+        roots.push_back(normalizeDirectory(directory));
+    }
+
+    WorkerPool pool;
+    startWorkerPool(&pool, defaultWorkerCount(1));
+
+    std::vector<std::vector<RomLibraryEntry>> found(roots.size());
+    parallelFor(&pool, static_cast<int>(roots.size()), [&](int index) {
+        found[index] = listRomFiles(roots[index]);
+        });
+
+    std::unordered_map<std::string, const RomLibraryEntry*> previous;
+    for (const RomLibraryEntry& entry : library->entries) {
+        previous.emplace(entry.path, &entry);
+    }
+
+    std::vector<RomLibraryEntry> entries;
+    std::vector<size_t> pending;
+    std::unordered_set<std::string> seen;
+    size_t previousInRoots = 0;
+    size_t stillPresent = 0;
+
+    for (const RomLibraryEntry& entry : library->entries) {
+        if (isInDirectories(entry.path, roots)) {
+            previousInRoots++;
+        }
+        else {
+            entries.push_back(entry);
+            seen.insert(entry.path);
+        }
+    }
+
+    for (std::vector<RomLibraryEntry>& files : found) {
+        for (RomLibraryEntry& file : files) {
+            if (!seen.insert(file.path).second) {
+                continue;
+            }
+
+            auto it = previous.find(file.path);
+            if (it != previous.end()) {
+                stillPresent++;
+                if (it->second->fileSize == file.fileSize && it->second->modifiedTime == file.modifiedTime) {
+                    entries.push_back(*it->second);
+                    result.cached++;
+                    continue;
+                }
+            }
+            pending.push_back(entries.size());
+            entries.push_back(std::move(file));
+        }
+    }
+
+    std::sort(pending.begin(), pending.end(), [&](size_t a, size_t b) {
+        return entries[a].fileSize > entries[b].fileSize;
+        });
+    parallelFor(&pool, static_cast<int>(pending.size()), [&](int index) {
+        analyzeRomFile(&entries[pending[index]]);
+        });
+
+    std::sort(entries.begin(), entries.end(), [](const RomLibraryEntry& a, const RomLibraryEntry& b) {
+        return a.path < b.path;
+        });
+    library->entries = std::move(entries);
+
+    result.analyzed = pending.size();
+    result.removed = previousInRoots - stillPresent;
+    result.scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static std::string formatRomEntry(const RomLibraryEntry& entry) {
+    std::ostringstream line;
+    line << entry.path << " : ";
+    if (!entry.headerValid) {
+        line << "en-tte absent";
+    }
+    else {
+        line << "\"" << entry.title << "\"";
+        if (entry.cgbFlag & 0x80) line << (entry.cgbFlag == 0xC0 ? " [CGB uniquement]" : " [CGB]");
+        if (entry.sgbFlag == 0x03) line << " [SGB]";
+        line << " type " << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(entry.cartridgeType);
+    }
+    line << " CRC32 " << std::hex << std::setw(8) << std::setfill('0') << entry.crc32 << " SHA-1 ";
+    for (uint8_t byte : entry.sha1) {
+        line << std::setw(2) << static_cast<int>(byte);
+    }
+    if (entry.headerValid && !entry.headerChecksumValid) line << " (checksum d'en-tte incorrect)";
+    if (entry.headerValid && !entry.globalChecksumValid) line << " (checksum global incorrect)";
+    return line.str();
+}
+
+bool runRomLibraryIndexer(const std::vector<std::string>& directories, const std::string& indexPath) {
+    RomLibrary library;
+    loadRomLibrary(&library, indexPath);
+
+    RomLibraryScanResult result = scanRomLibrary(&library, directories);
+
+    std::vector<std::string> roots;
+    for (const std::string& directory : directories) {
+        roots.push_back(normalizeDirectory(directory));
+    }
+
+    size_t listed = 0;
+    for (const RomLibraryEntry& entry : library.entries) {
+        if (isInDirectories(entry.path, roots)) {
+            std::cout << formatRomEntry(entry) << std::endl;
+            listed++;
+        }
+    }
+    std::cout << listed << " ROMs indexes (" << result.analyzed << " analyses, " << result.cached << " en cache, "
+        << result.removed << " supprimes) en " << std::fixed << std::setprecision(2) << result.scanSeconds << " s" << std::endl;
+
+    return result.analyzed == 0 && result.removed == 0 ? true : saveRomLibrary(&library);
+}
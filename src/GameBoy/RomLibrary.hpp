@@ -0,0 +1,58 @@
+#pragma once
+
+#include "RomHash.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr char ROM_LIBRARY_MAGIC[4] = { 'G', 'B', 'I', 'X' };
+constexpr uint8_t ROM_LIBRARY_VERSION = 1;
+constexpr uint16_t ROM_TITLE_ADDRESS = 0x0134;
+constexpr size_t ROM_TITLE_LENGTH = 16;
+constexpr uint16_t ROM_CGB_FLAG = 0x0143;
+constexpr uint16_t ROM_SGB_FLAG = 0x0146;
+constexpr uint16_t ROM_CARTRIDGE_TYPE = 0x0147;
+constexpr uint16_t ROM_SIZE_CODE = 0x0148;
+constexpr uint16_t ROM_RAM_SIZE_CODE = 0x0149;
+
+struct RomLibraryEntry {
+    std::string path;
+    int64_t modifiedTime = 0;
+    uint64_t fileSize = 0;
+
+    bool headerValid = false;
+    std::string title;
+    uint8_t cgbFlag = 0;
+    uint8_t sgbFlag = 0;
+    uint8_t cartridgeType = 0;
+    uint8_t romSizeCode = 0;
+    uint8_t ramSizeCode = 0;
+    uint8_t headerChecksum = 0;
+    bool headerChecksumValid = false;
+    uint16_t globalChecksum = 0;
+    bool globalChecksumValid = false;
+
+    uint32_t crc32 = 0;
+    uint8_t sha1[SHA1_DIGEST_SIZE] = {};
+};
+
+struct RomLibrary {
+    std::string indexPath;
+    std::vector<RomLibraryEntry> entries;
+};
+
+struct RomLibraryScanResult {
+    size_t analyzed;
+    size_t cached;
+    size_t removed;
+    double scanSeconds;
+};
+
+bool isRomLibraryDirectory(const std::string& path);
+
+bool loadRomLibrary(RomLibrary* library, const std::string& indexPath);
+bool saveRomLibrary(const RomLibrary* library);
+
+RomLibraryScanResult scanRomLibrary(RomLibrary* library, const std::vector<std::string>& directories);
+bool runRomLibraryIndexer(const std::vector<std::string>& directories, const std::string& indexPath);
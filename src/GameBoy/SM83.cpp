@@ -77,6 +77,7 @@ uint16_t getAddressWithIncrementOrDecrement(SM83* CPU, uint8_t OPCode) {
     return 0;
 }
 
+template <MBC Mapper>
 uint8_t getSourceRegisterValue8(SM83* CPU, uint8_t OPCode) {
     switch (OPCode & 0b00000111) {
     case 0: return CPU->B;
@@ -85,7 +86,7 @@ uint8_t getSourceRegisterValue8(SM83* CPU, uint8_t OPCode) {
     case 3: return CPU->E;
     case 4: return CPU->H;
     case 5: return CPU->L;
-    case 6: return readMemoryByte(CPU->GB, CPU->HL);
+    case 6: return readMemoryByte<Mapper>(CPU->GB, CPU->HL);
     case 7: return CPU->A;
     }
     return 0;
@@ -119,84 +120,90 @@ void executeALUOperation(SM83* CPU, uint8_t OPCode, uint8_t OPCode2) {
     }
 }
 
+template <MBC Mapper>
 void pushToStack(SM83* CPU, uint16_t val) {
     CPU->SP -= 2;
-    writeMemoryWord(CPU->GB, CPU->SP, val);
+    writeMemoryWord<Mapper>(CPU->GB, CPU->SP, val);
 }
 
+template <MBC Mapper>
 uint16_t popFromStack(SM83* CPU) {
-    uint16_t val = readMemoryWord(CPU->GB, CPU->SP);
+    uint16_t val = readMemoryWord<Mapper>(CPU->GB, CPU->SP);
     CPU->SP += 2;
     return val;
 }
 
+template <MBC Mapper>
 void executeInstruction(SM83* CPU) {
-    uint8_t OPCode = readMemoryByte(CPU->GB, CPU->PC++);
+    uint8_t OPCode = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
 
     switch ((OPCode & 0b11000000) >> 6) {
     case 0:
-        executeOpcodeGroup0(CPU, OPCode);
+        executeOpcodeGroup0<Mapper>(CPU, OPCode);
         break;
     case 1:
-        executeOpcodeGroup1(CPU, OPCode);
+        executeOpcodeGroup1<Mapper>(CPU, OPCode);
         break;
     case 2:
-        executeOpcodeGroup2(CPU, OPCode);
+        executeOpcodeGroup2<Mapper>(CPU, OPCode);
         break;
     case 3:
-        executeOpcodeGroup3(CPU, OPCode);
+        executeOpcodeGroup3<Mapper>(CPU, OPCode);
         break;
     }
 }
 
+template <MBC Mapper>
 void executeOpcodeGroup0(SM83* CPU, uint8_t OPCode) {
     if ((OPCode & 0b00000111) == 0) {
         if ((OPCode & 0b00100000) == 0) {
-            executeGroup0Subgroup0(CPU, OPCode);
+            executeGroup0Subgroup0<Mapper>(CPU, OPCode);
         }
         else {
-            jumpRelativeConditional(CPU, OPCode);
+            jumpRelativeConditional<Mapper>(CPU, OPCode);
         }
     }
     else {
         if ((OPCode & 0b00000100) == 0) {
-            executeGroup0Subgroup1(CPU, OPCode);
+            executeGroup0Subgroup1<Mapper>(CPU, OPCode);
         }
         else {
-            executeGroup0Subgroup2(CPU, OPCode);
+            executeGroup0Subgroup2<Mapper>(CPU, OPCode);
         }
     }
 }
 
+template <MBC Mapper>
 void executeGroup0Subgroup0(SM83* CPU, uint8_t OPCode) {
     switch ((OPCode & 0b00011000) >> 3) {
     case 0:
         break;
     case 1:
-        loadMemoryAddressWithSP(CPU);
+        loadMemoryAddressWithSP<Mapper>(CPU);
         break;
     case 2:
         CPU->isStopped = true;
         break;
     case 3:
-        jumpRelative(CPU);
+        jumpRelative<Mapper>(CPU);
         break;
     }
 }
 
+template <MBC Mapper>
 void executeGroup0Subgroup1(SM83* CPU, uint8_t OPCode) {
     switch (OPCode & 0x0F) {
     case 0x01:
-        loadRegisterPairImmediate(CPU, OPCode);
+        loadRegisterPairImmediate<Mapper>(CPU, OPCode);
         break;
     case 0x09:
         addHLWithRegisterPair(CPU, OPCode);
         break;
     case 0x02:
-        loadMemoryWithA(CPU, OPCode);
+        loadMemoryWithA<Mapper>(CPU, OPCode);
         break;
     case 0x0A:
-        loadAWithMemory(CPU, OPCode);
+        loadAWithMemory<Mapper>(CPU, OPCode);
         break;
     case 0x03:
         incrementRegisterPair(CPU, OPCode);
@@ -207,16 +214,17 @@ void executeGroup0Subgroup1(SM83* CPU, uint8_t OPCode) {
     }
 }
 
+template <MBC Mapper>
 void executeGroup0Subgroup2(SM83* CPU, uint8_t OPCode) {
     switch (OPCode & 0b00000011) {
     case 0:
-        incrementRegister(CPU, OPCode);
+        incrementRegister<Mapper>(CPU, OPCode);
         break;
     case 1:
-        decrementRegister(CPU, OPCode);
+        decrementRegister<Mapper>(CPU, OPCode);
         break;
     case 2:
-        loadRegisterImmediate(CPU, OPCode);
+        loadRegisterImmediate<Mapper>(CPU, OPCode);
         break;
     case 3:
         executeSpecialOperation(CPU, OPCode);
@@ -224,22 +232,25 @@ void executeGroup0Subgroup2(SM83* CPU, uint8_t OPCode) {
     }
 }
 
+template <MBC Mapper>
 void jumpRelative(SM83* CPU) {
-    int8_t displacement = readMemoryByte(CPU->GB, CPU->PC++);
+    int8_t displacement = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
     CPU->currentCycles += 4;
     CPU->PC += displacement;
 }
 
+template <MBC Mapper>
 void jumpRelativeConditional(SM83* CPU, uint8_t OPCode) {
-    int8_t displacement = readMemoryByte(CPU->GB, CPU->PC++);
+    int8_t displacement = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
     if (evalCondition(CPU, OPCode)) {
         CPU->currentCycles += 4;
         CPU->PC += displacement;
     }
 }
 
+template <MBC Mapper>
 void loadRegisterPairImmediate(SM83* CPU, uint8_t OPCode) {
-    uint16_t value = readMemoryWord(CPU->GB, CPU->PC);
+    uint16_t value = readMemoryWord<Mapper>(CPU->GB, CPU->PC);
     CPU->PC += 2;
     *getRegisterPointer16(CPU, OPCode) = value;
 }
@@ -253,14 +264,16 @@ void addHLWithRegisterPair(SM83* CPU, uint8_t OPCode) {
         (prevHL & 0x00FF) > CPU->L);
 }
 
+template <MBC Mapper>
 void loadMemoryWithA(SM83* CPU, uint8_t OPCode) {
     uint16_t address = getAddressWithIncrementOrDecrement(CPU, OPCode);
-    writeMemoryByte(CPU->GB, address, CPU->A);
+    writeMemoryByte<Mapper>(CPU->GB, address, CPU->A);
 }
 
+template <MBC Mapper>
 void loadAWithMemory(SM83* CPU, uint8_t OPCode) {
     uint16_t address = getAddressWithIncrementOrDecrement(CPU, OPCode);
-    CPU->A = readMemoryByte(CPU->GB, address);
+    CPU->A = readMemoryByte<Mapper>(CPU->GB, address);
 }
 
 void incrementRegisterPair(SM83* CPU, uint8_t OPCode) {
@@ -273,6 +286,7 @@ void decrementRegisterPair(SM83* CPU, uint8_t OPCode) {
     (*getRegisterPointer16(CPU, OPCode))--;
 }
 
+template <MBC Mapper>
 void incrementRegister(SM83* CPU, uint8_t OPCode) {
     uint8_t* reg = getDestinationRegisterPointer8(CPU, OPCode);
     uint8_t preValue, postValue;
@@ -282,13 +296,14 @@ void incrementRegister(SM83* CPU, uint8_t OPCode) {
         postValue = *reg;
     }
     else {
-        preValue = readMemoryByte(CPU->GB, CPU->HL);
+        preValue = readMemoryByte<Mapper>(CPU->GB, CPU->HL);
         postValue = preValue + 1;
-        writeMemoryByte(CPU->GB, CPU->HL, postValue);
+        writeMemoryByte<Mapper>(CPU->GB, CPU->HL, postValue);
     }
     resolveFlags(CPU, ZERO_FLAG | HALF_CARRY_FLAG, preValue, postValue, 0);
 }
 
+template <MBC Mapper>
 void decrementRegister(SM83* CPU, uint8_t OPCode) {
     uint8_t* reg = getDestinationRegisterPointer8(CPU, OPCode);
     uint8_t preValue, postValue;
@@ -298,21 +313,22 @@ void decrementRegister(SM83* CPU, uint8_t OPCode) {
         postValue = *reg;
     }
     else {
-        preValue = readMemoryByte(CPU->GB, CPU->HL);
+        preValue = readMemoryByte<Mapper>(CPU->GB, CPU->HL);
         postValue = preValue - 1;
-        writeMemoryByte(CPU->GB, CPU->HL, postValue);
+        writeMemoryByte<Mapper>(CPU->GB, CPU->HL, postValue);
     }
     resolveFlags(CPU, ZERO_FLAG | SUBTRACT_FLAG | HALF_CARRY_FLAG, preValue, postValue, 0);
 }
 
+template <MBC Mapper>
 void loadRegisterImmediate(SM83* CPU, uint8_t OPCode) {
-    uint8_t value = readMemoryByte(CPU->GB, CPU->PC++);
+    uint8_t value = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
     uint8_t* reg = getDestinationRegisterPointer8(CPU, OPCode);
     if (reg) {
         *reg = value;
     }
     else {
-        writeMemoryByte(CPU->GB, CPU->HL, value);
+        writeMemoryByte<Mapper>(CPU->GB, CPU->HL, value);
     }
 }
 
@@ -405,91 +421,97 @@ void complementCarryFlag(SM83* CPU) {
     CPU->F ^= CARRY_FLAG;
 }
 
+template <MBC Mapper>
 void executeOpcodeGroup1(SM83* CPU, uint8_t OPCode) {
     if (OPCode == 0x76) {
         CPU->isHalted = true;
     }
     else {
         uint8_t* destReg = getDestinationRegisterPointer8(CPU, OPCode);
-        uint8_t value = getSourceRegisterValue8(CPU, OPCode);
+        uint8_t value = getSourceRegisterValue8<Mapper>(CPU, OPCode);
         if (destReg) {
             *destReg = value;
         }
         else {
-            writeMemoryByte(CPU->GB, CPU->HL, value);
+            writeMemoryByte<Mapper>(CPU->GB, CPU->HL, value);
         }
     }
 }
 
+template <MBC Mapper>
 void executeOpcodeGroup2(SM83* CPU, uint8_t OPCode) {
-    uint8_t value = getSourceRegisterValue8(CPU, OPCode);
+    uint8_t value = getSourceRegisterValue8<Mapper>(CPU, OPCode);
     executeALUOperation(CPU, OPCode, value);
 }
 
+template <MBC Mapper>
 void executeOpcodeGroup3(SM83* CPU, uint8_t OPCode) {
     switch (OPCode & 0b00000111) {
     case 0:
         if ((OPCode & 0b00100000) == 0) {
-            returnConditional(CPU, OPCode);
+            returnConditional<Mapper>(CPU, OPCode);
         }
         else {
-            executeGroup3Specials0(CPU, OPCode);
+            executeGroup3Specials0<Mapper>(CPU, OPCode);
         }
         break;
     case 1:
         if ((OPCode & 0b00001000) == 0) {
-            popRegisterPair(CPU, OPCode);
+            popRegisterPair<Mapper>(CPU, OPCode);
         }
         else {
-            executeGroup3Specials1(CPU, OPCode);
+            executeGroup3Specials1<Mapper>(CPU, OPCode);
         }
         break;
     case 2:
         if ((OPCode & 0b00100000) == 0) {
-            jumpConditional(CPU, OPCode);
+            jumpConditional<Mapper>(CPU, OPCode);
         }
         else {
-            executeGroup3Specials2(CPU, OPCode);
+            executeGroup3Specials2<Mapper>(CPU, OPCode);
         }
         break;
     case 3:
-        executeGroup3Specials3(CPU, OPCode);
+        executeGroup3Specials3<Mapper>(CPU, OPCode);
         break;
     case 4:
-        callConditional(CPU, OPCode);
+        callConditional<Mapper>(CPU, OPCode);
         break;
     case 5:
         if ((OPCode & 0b00001000) == 0) {
-            pushRegisterPair(CPU, OPCode);
+            pushRegisterPair<Mapper>(CPU, OPCode);
         }
         else {
-            callImmediate(CPU);
+            callImmediate<Mapper>(CPU);
         }
         break;
     case 6:
-        aluImmediate(CPU, OPCode);
+        aluImmediate<Mapper>(CPU, OPCode);
         break;
     case 7:
-        restart(CPU, OPCode);
+        restart<Mapper>(CPU, OPCode);
         break;
     }
 }
 
+template <MBC Mapper>
 void returnConditional(SM83* CPU, uint8_t OPCode) {
     CPU->currentCycles += 4;
     if (evalCondition(CPU, OPCode)) {
         CPU->currentCycles += 4;
-        CPU->PC = popFromStack(CPU);
+        CPU->PC = popFromStack<Mapper>(CPU);
     }
 }
 
+template <MBC Mapper>
 void popRegisterPair(SM83* CPU, uint8_t OPCode) {
-    *getStackPointer16(CPU, OPCode) = popFromStack(CPU);
+    *getStackPointer16(CPU, OPCode) = popFromStack<Mapper>(CPU);
     CPU->F &= 0xF0;
 }
 
+template <MBC Mapper>
 void jumpConditional(SM83* CPU, uint8_t OPCode) {
-    uint16_t address = readMemoryWord(CPU->GB, CPU->PC);
+    uint16_t address = readMemoryWord<Mapper>(CPU->GB, CPU->PC);
     CPU->PC += 2;
     if (evalCondition(CPU, OPCode)) {
         CPU->currentCycles += 4;
@@ -497,29 +519,31 @@ void jumpConditional(SM83* CPU, uint8_t OPCode) {
     }
 }
 
+template <MBC Mapper>
 void executeGroup3Specials0(SM83* CPU, uint8_t OPCode) {
     switch ((OPCode & 0b00011000) >> 3) {
     case 0: {
-        uint8_t n = readMemoryByte(CPU->GB, CPU->PC++);
-        writeMemoryByte(CPU->GB, 0xFF00 + n, CPU->A);
+        uint8_t n = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
+        writeMemoryByte<Mapper>(CPU->GB, 0xFF00 + n, CPU->A);
         break;
     }
     case 1:
-        addSPImmediate(CPU);
+        addSPImmediate<Mapper>(CPU);
         break;
     case 2: {
-        uint8_t num = readMemoryByte(CPU->GB, CPU->PC++);
-        CPU->A = readMemoryByte(CPU->GB, 0xFF00 + num);
+        uint8_t num = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
+        CPU->A = readMemoryByte<Mapper>(CPU->GB, 0xFF00 + num);
         break;
     }
     case 3:
-        loadHLWithSPDisplacement(CPU);
+        loadHLWithSPDisplacement<Mapper>(CPU);
         break;
     }
 }
 
+template <MBC Mapper>
 void addSPImmediate(SM83* CPU) {
-    int8_t displacement = readMemoryByte(CPU->GB, CPU->PC++);
+    int8_t displacement = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
     uint16_t preSP = CPU->SP;
     CPU->currentCycles += 8;
     CPU->SP += displacement;
@@ -528,8 +552,9 @@ void addSPImmediate(SM83* CPU) {
         CPU->SP & 0x00FF, 0);
 }
 
+template <MBC Mapper>
 void loadHLWithSPDisplacement(SM83* CPU) {
-    int8_t displacement = readMemoryByte(CPU->GB, CPU->PC++);
+    int8_t displacement = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
     CPU->currentCycles += 4;
     CPU->HL = CPU->SP + displacement;
     CPU->F &= ~ZERO_FLAG;
@@ -537,15 +562,16 @@ void loadHLWithSPDisplacement(SM83* CPU) {
         CPU->L, 0);
 }
 
+template <MBC Mapper>
 void executeGroup3Specials1(SM83* CPU, uint8_t OPCode) {
     switch ((OPCode & 0b00110000) >> 4) {
     case 0:
         CPU->currentCycles += 4;
-        CPU->PC = popFromStack(CPU);
+        CPU->PC = popFromStack<Mapper>(CPU);
         break;
     case 1:
         CPU->currentCycles += 4;
-        CPU->PC = popFromStack(CPU);
+        CPU->PC = popFromStack<Mapper>(CPU);
         CPU->IME = true;
         break;
     case 2:
@@ -558,41 +584,43 @@ void executeGroup3Specials1(SM83* CPU, uint8_t OPCode) {
     }
 }
 
+template <MBC Mapper>
 void executeGroup3Specials2(SM83* CPU, uint8_t OPCode) {
     switch ((OPCode & 0b00011000) >> 3) {
     case 0: {
-        writeMemoryByte(CPU->GB, 0xFF00 + CPU->C, CPU->A);
+        writeMemoryByte<Mapper>(CPU->GB, 0xFF00 + CPU->C, CPU->A);
         break;
     }
     case 1: {
-        uint16_t address = readMemoryWord(CPU->GB, CPU->PC);
+        uint16_t address = readMemoryWord<Mapper>(CPU->GB, CPU->PC);
         CPU->PC += 2;
-        writeMemoryByte(CPU->GB, address, CPU->A);
+        writeMemoryByte<Mapper>(CPU->GB, address, CPU->A);
         break;
     }
     case 2: {
-        CPU->A = readMemoryByte(CPU->GB, 0xFF00 + CPU->C);
+        CPU->A = readMemoryByte<Mapper>(CPU->GB, 0xFF00 + CPU->C);
         break;
     }
     case 3: {
-        uint16_t addr = readMemoryWord(CPU->GB, CPU->PC);
+        uint16_t addr = readMemoryWord<Mapper>(CPU->GB, CPU->PC);
         CPU->PC += 2;
-        CPU->A = readMemoryByte(CPU->GB, addr);
+        CPU->A = readMemoryByte<Mapper>(CPU->GB, addr);
         break;
     }
     }
 }
 
+template <MBC Mapper>
 void executeGroup3Specials3(SM83* CPU, uint8_t OPCode) {
     switch ((OPCode & 0b00111000) >> 3) {
     case 0: {
-        uint16_t address = readMemoryWord(CPU->GB, CPU->PC);
+        uint16_t address = readMemoryWord<Mapper>(CPU->GB, CPU->PC);
         CPU->PC = address;
         CPU->currentCycles += 4;
         break;
     }
     case 1:
-        executePrefixCB(CPU);
+        executePrefixCB<Mapper>(CPU);
         break;
     case 6:
         CPU->IME = false;
@@ -606,9 +634,10 @@ void executeGroup3Specials3(SM83* CPU, uint8_t OPCode) {
     }
 }
 
+template <MBC Mapper>
 void executePrefixCB(SM83* CPU) {
-    uint8_t cbCode = readMemoryByte(CPU->GB, CPU->PC++);
-    uint8_t value = getSourceRegisterValue8(CPU, cbCode);
+    uint8_t cbCode = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
+    uint8_t value = getSourceRegisterValue8<Mapper>(CPU, cbCode);
     uint8_t* destReg = getDestinationRegisterPointer8(CPU, cbCode << 3);
     uint8_t bit = (cbCode & 0b00111000) >> 3;
     int store = 1;
@@ -670,50 +699,57 @@ void executePrefixCB(SM83* CPU) {
     }
     if (store) {
         if (destReg) *destReg = value;
-        else writeMemoryByte(CPU->GB, CPU->HL, value);
+        else writeMemoryByte<Mapper>(CPU->GB, CPU->HL, value);
     }
 }
 
+template <MBC Mapper>
 void callConditional(SM83* CPU, uint8_t OPCode) {
-    uint16_t address = readMemoryWord(CPU->GB, CPU->PC);
+    uint16_t address = readMemoryWord<Mapper>(CPU->GB, CPU->PC);
     CPU->PC += 2;
     if (evalCondition(CPU, OPCode)) {
         CPU->currentCycles += 4;
-        pushToStack(CPU, CPU->PC);
+        pushToStack<Mapper>(CPU, CPU->PC);
         CPU->PC = address;
     }
 }
 
+template <MBC Mapper>
 void pushRegisterPair(SM83* CPU, uint8_t OPCode) {
     CPU->currentCycles += 4;
-    pushToStack(CPU, *getStackPointer16(CPU, OPCode));
+    pushToStack<Mapper>(CPU, *getStackPointer16(CPU, OPCode));
 }
 
+template <MBC Mapper>
 void callImmediate(SM83* CPU) {
-    uint16_t address = readMemoryWord(CPU->GB, CPU->PC);
+    uint16_t address = readMemoryWord<Mapper>(CPU->GB, CPU->PC);
     CPU->PC += 2;
-    pushToStack(CPU, CPU->PC);
+    pushToStack<Mapper>(CPU, CPU->PC);
     CPU->currentCycles += 4;
     CPU->PC = address;
 }
 
+template <MBC Mapper>
 void aluImmediate(SM83* CPU, uint8_t OPCode) {
-    uint8_t value = readMemoryByte(CPU->GB, CPU->PC++);
+    uint8_t value = readMemoryByte<Mapper>(CPU->GB, CPU->PC++);
     executeALUOperation(CPU, OPCode, value);
 }
 
+template <MBC Mapper>
 void restart(SM83* CPU, uint8_t OPCode) {
-    pushToStack(CPU, CPU->PC);
+    pushToStack<Mapper>(CPU, CPU->PC);
     CPU->currentCycles += 4;
     CPU->PC = OPCode & 0b00111000;
 }
 
+template <MBC Mapper>
 void loadMemoryAddressWithSP(SM83* CPU) {
-    uint16_t addr = readMemoryWord(CPU->GB, CPU->PC);
+    uint16_t addr = readMemoryWord<Mapper>(CPU->GB, CPU->PC);
     CPU->PC += 2;
-    writeMemoryWord(CPU->GB, addr, CPU->SP);
+    writeMemoryWord<Mapper>(CPU->GB, addr, CPU->SP);
 }
 
+template <MBC Mapper>
 void CPUClock(SM83* CPU) {
     if (CPU->illegalOpcode) return;
     if (CPU->currentCycles == 0 && (CPU->GB->IE & CPU->GB->io[IF])) {
@@ -729,7 +765,7 @@ void CPUClock(SM83* CPU) {
             }
             if (i < 5) {
                 CPU->GB->io[IF] &= ~(1 << i);
-                pushToStack(CPU, CPU->PC);
+                pushToStack<Mapper>(CPU, CPU->PC);
                 CPU->PC = 0b01000000 | (i << 3);
             }
         }
@@ -739,7 +775,13 @@ void CPUClock(SM83* CPU) {
         CPU->ei = false;
     }
     if (CPU->currentCycles == 0 && !CPU->isHalted && !CPU->isStopped) {
-        executeInstruction(CPU);
+        executeInstruction<Mapper>(CPU);
     }
     if (CPU->currentCycles) CPU->currentCycles--;
 }
+
+template void CPUClock<MBC::MBC0>(SM83* CPU);
+template void CPUClock<MBC::MBC1>(SM83* CPU);
+template void CPUClock<MBC::MBC2>(SM83* CPU);
+template void CPUClock<MBC::MBC3>(SM83* CPU);
+template void CPUClock<MBC::MBC5>(SM83* CPU);
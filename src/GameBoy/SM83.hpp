@@ -17,6 +17,7 @@ enum Condition {
 };
 
 struct GameBoy;
+enum class MBC;
 
 struct SM83 {
     GameBoy* GB;
@@ -64,25 +65,25 @@ struct SM83 {
 };
 
 
-void executeInstruction(SM83* CPU);
-void executeOpcodeGroup0(SM83* CPU, uint8_t OPCode);
-void executeOpcodeGroup1(SM83* CPU, uint8_t OPCode);
-void executeOpcodeGroup2(SM83* CPU, uint8_t OPCode);
-void executeOpcodeGroup3(SM83* CPU, uint8_t OPCode);
-void executeGroup0Subgroup0(SM83* CPU, uint8_t OPCode);
-void executeGroup0Subgroup1(SM83* CPU, uint8_t OPCode);
-void executeGroup0Subgroup2(SM83* CPU, uint8_t OPCode);
-void jumpRelative(SM83* CPU);
-void jumpRelativeConditional(SM83* CPU, uint8_t OPCode);
-void loadRegisterPairImmediate(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeInstruction(SM83* CPU);
+template <MBC Mapper> void executeOpcodeGroup0(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeOpcodeGroup1(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeOpcodeGroup2(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeOpcodeGroup3(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeGroup0Subgroup0(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeGroup0Subgroup1(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeGroup0Subgroup2(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void jumpRelative(SM83* CPU);
+template <MBC Mapper> void jumpRelativeConditional(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void loadRegisterPairImmediate(SM83* CPU, uint8_t OPCode);
 void addHLWithRegisterPair(SM83* CPU, uint8_t OPCode);
-void loadMemoryWithA(SM83* CPU, uint8_t OPCode);
-void loadAWithMemory(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void loadMemoryWithA(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void loadAWithMemory(SM83* CPU, uint8_t OPCode);
 void incrementRegisterPair(SM83* CPU, uint8_t OPCode);
 void decrementRegisterPair(SM83* CPU, uint8_t OPCode);
-void incrementRegister(SM83* CPU, uint8_t OPCode);
-void decrementRegister(SM83* CPU, uint8_t OPCode);
-void loadRegisterImmediate(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void incrementRegister(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void decrementRegister(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void loadRegisterImmediate(SM83* CPU, uint8_t OPCode);
 void executeSpecialOperation(SM83* CPU, uint8_t OPCode);
 void rotateLeftCarryA(SM83* CPU);
 void rotateRightCarryA(SM83* CPU);
@@ -92,20 +93,20 @@ void decimalAdjustA(SM83* CPU);
 void complementA(SM83* CPU);
 void setCarryFlag(SM83* CPU);
 void complementCarryFlag(SM83* CPU);
-void returnConditional(SM83* CPU, uint8_t OPCode);
-void popRegisterPair(SM83* CPU, uint8_t OPCode);
-void jumpConditional(SM83* CPU, uint8_t OPCode);
-void executeGroup3Specials0(SM83* CPU, uint8_t OPCode);
-void executeGroup3Specials1(SM83* CPU, uint8_t OPCode);
-void executeGroup3Specials2(SM83* CPU, uint8_t OPCode);
-void executeGroup3Specials3(SM83* CPU, uint8_t OPCode);
-void executePrefixCB(SM83* CPU);
-void callConditional(SM83* CPU, uint8_t OPCode);
-void pushRegisterPair(SM83* CPU, uint8_t OPCode);
-void callImmediate(SM83* CPU);
-void aluImmediate(SM83* CPU, uint8_t OPCode);
-void restart(SM83* CPU, uint8_t OPCode);
-void loadMemoryAddressWithSP(SM83* CPU);
-void addSPImmediate(SM83* CPU);
-void loadHLWithSPDisplacement(SM83* CPU);
-void CPUClock(SM83* CPU);
+template <MBC Mapper> void returnConditional(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void popRegisterPair(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void jumpConditional(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeGroup3Specials0(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeGroup3Specials1(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeGroup3Specials2(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executeGroup3Specials3(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void executePrefixCB(SM83* CPU);
+template <MBC Mapper> void callConditional(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void pushRegisterPair(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void callImmediate(SM83* CPU);
+template <MBC Mapper> void aluImmediate(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void restart(SM83* CPU, uint8_t OPCode);
+template <MBC Mapper> void loadMemoryAddressWithSP(SM83* CPU);
+template <MBC Mapper> void addSPImmediate(SM83* CPU);
+template <MBC Mapper> void loadHLWithSPDisplacement(SM83* CPU);
+template <MBC Mapper> void CPUClock(SM83* CPU);
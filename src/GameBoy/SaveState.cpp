@@ -0,0 +1,325 @@
+#include "SaveState.hpp"
+
+#include "BatterySave.hpp"
+#include "RomImage.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+static size_t getCartridgeRAMSize(const Cartridge* cart) {
+    return cart && cart->ram ? static_cast<size_t>(cart->ramBanks) * ERAM_BANK_SIZE : 0;
+}
+
+static uint32_t getCartridgeCRC32(Cartridge* cart) {
+    if (!cart || !cart->image) return 0;
+    computeRomImageChecksums(cart->image);
+    return cart->image->crc32;
+}
+
+static void captureCPU(const SM83* cpu, SaveStateCPU* state) {
+    state->AF = cpu->AF;
+    state->BC = cpu->BC;
+    state->DE = cpu->DE;
+    state->HL = cpu->HL;
+    state->SP = cpu->SP;
+    state->PC = cpu->PC;
+    state->currentCycles = cpu->currentCycles;
+    state->IME = cpu->IME;
+    state->ei = cpu->ei;
+    state->isHalted = cpu->isHalted;
+    state->isStopped = cpu->isStopped;
+}
+
+static void restoreCPU(SM83* cpu, const SaveStateCPU* state) {
+    cpu->AF = state->AF;
+    cpu->BC = state->BC;
+    cpu->DE = state->DE;
+    cpu->HL = state->HL;
+    cpu->SP = state->SP;
+    cpu->PC = state->PC;
+    cpu->currentCycles = state->currentCycles;
+    cpu->IME = state->IME;
+    cpu->ei = state->ei;
+    cpu->isHalted = state->isHalted;
+    cpu->isStopped = state->isStopped;
+    cpu->illegalOpcode = false;
+}
+
+static void capturePPU(const GameBoyPPU* ppu, SaveStatePPU* state) {
+    state->currentCycle = ppu->currentCycle;
+    state->currentScanline = ppu->currentScanline;
+    state->currentPixelX = ppu->currentPixelX;
+    state->windowScanline = ppu->windowScanline;
+    state->scanlineWindowStart = ppu->scanlineWindowStart;
+    state->isFrameComplete = ppu->isFrameComplete;
+    state->isRenderingWindow = ppu->isRenderingWindow;
+
+    state->bgTileByte0 = ppu->bgTileByte0;
+    state->bgTileByte1 = ppu->bgTileByte1;
+    state->bgTileX = ppu->bgTileX;
+    state->bgTileY = ppu->bgTileY;
+    state->bgFineX = ppu->bgFineX;
+    state->bgFineY = ppu->bgFineY;
+
+    state->spriteTileByte0 = ppu->spriteTileByte0;
+    state->spriteTileByte1 = ppu->spriteTileByte1;
+    state->spritePalette = ppu->spritePalette;
+    state->spriteBGPriority = ppu->spriteBGPriority;
+    std::memcpy(state->activeSprites, ppu->activeSprites, sizeof(state->activeSprites));
+    state->activeSpriteCount = ppu->activeSpriteCount;
+}
+
+static void restorePPU(GameBoyPPU* ppu, const SaveStatePPU* state) {
+    ppu->currentCycle = state->currentCycle;
+    ppu->currentScanline = state->currentScanline;
+    ppu->currentPixelX = state->currentPixelX;
+    ppu->windowScanline = state->windowScanline;
+    ppu->scanlineWindowStart = state->scanlineWindowStart;
+    ppu->isFrameComplete = state->isFrameComplete;
+    ppu->isRenderingWindow = state->isRenderingWindow;
+
+    ppu->bgTileByte0 = state->bgTileByte0;
+    ppu->bgTileByte1 = state->bgTileByte1;
+    ppu->bgTileX = state->bgTileX;
+    ppu->bgTileY = state->bgTileY;
+    ppu->bgFineX = state->bgFineX;
+    ppu->bgFineY = state->bgFineY;
+
+    ppu->spriteTileByte0 = state->spriteTileByte0;
+    ppu->spriteTileByte1 = state->spriteTileByte1;
+    ppu->spritePalette = state->spritePalette;
+    ppu->spriteBGPriority = state->spriteBGPriority;
+    std::memcpy(ppu->activeSprites, state->activeSprites, sizeof(state->activeSprites));
+    ppu->activeSpriteCount = state->activeSpriteCount;
+
+    invalidatePPUCaches(ppu);
+}
+
+static void captureAPU(GameBoyAPU* apu, SaveStateAPU* state) {
+    syncAPU(apu);
+    state->elapsedCycles = apu->elapsedCycles;
+    state->apuDivider = apu->apuDivider;
+    state->CH1 = apu->CH1;
+    state->CH2 = apu->CH2;
+    state->CH3 = apu->CH3;
+    state->CH4 = apu->CH4;
+}
+
+static void restoreAPU(GameBoyAPU* apu, const SaveStateAPU* state) {
+    apu->elapsedCycles = state->elapsedCycles;
+    apu->apuDivider = state->apuDivider;
+    apu->CH1 = state->CH1;
+    apu->CH2 = state->CH2;
+    apu->CH3 = state->CH3;
+    apu->CH4 = state->CH4;
+    apu->pendingCycles = 0;
+    apu->cyclesUntilEvent = 1;
+    apu->outputDirty = true;
+}
+
+static void captureBus(const GameBoy* gb, SaveStateBus* state) {
+    std::memcpy(state->vram, gb->vram, sizeof(state->vram));
+    std::memcpy(state->wram, gb->wram, sizeof(state->wram));
+    std::memcpy(state->oam, gb->oam, sizeof(state->oam));
+    std::memcpy(state->io, gb->io, sizeof(state->io));
+    std::memcpy(state->hram, gb->hram, sizeof(state->hram));
+    state->IE = gb->IE;
+    state->div = gb->div;
+    state->prev_timer_inc = gb->prev_timer_inc;
+    state->timer_overflow = gb->timer_overflow;
+    state->prev_stat_int = gb->prev_stat_int;
+    state->dma_active = gb->dma_active;
+    state->dma_index = gb->dma_index;
+    state->dma_currentCycles = gb->dma_currentCycles;
+}
+
+static void restoreBus(GameBoy* gb, const SaveStateBus* state) {
+    std::memcpy(gb->vram, state->vram, sizeof(gb->vram));
+    std::memcpy(gb->wram, state->wram, sizeof(gb->wram));
+    std::memcpy(gb->oam, state->oam, sizeof(gb->oam));
+    std::memcpy(gb->io, state->io, sizeof(gb->io));
+    std::memcpy(gb->hram, state->hram, sizeof(gb->hram));
+    gb->IE = state->IE;
+    gb->div = state->div;
+    gb->prev_timer_inc = state->prev_timer_inc;
+    gb->timer_overflow = state->timer_overflow;
+    gb->prev_stat_int = state->prev_stat_int;
+    gb->dma_active = state->dma_active;
+    gb->dma_index = state->dma_index;
+    gb->dma_currentCycles = state->dma_currentCycles;
+}
+
+static void captureCartridge(const Cartridge* cart, SaveStateCartridge* state, uint8_t* ram) {
+    state->mapper = static_cast<uint8_t>(cart->Mapper);
+    std::memcpy(state->mapperState, &cart->MBC1, SAVE_STATE_MAPPER_SIZE);
+    state->clockCycles = cart->clockCycles;
+    std::memcpy(ram, cart->ram, getCartridgeRAMSize(cart));
+}
+
+static void restoreCartridge(Cartridge* cart, const SaveStateCartridge* state, const uint8_t* ram) {
+    std::memcpy(&cart->MBC1, state->mapperState, SAVE_STATE_MAPPER_SIZE);
+    cart->clockCycles = state->clockCycles;
+
+    size_t ramSize = getCartridgeRAMSize(cart);
+    std::memcpy(cart->ram, ram, ramSize);
+    if (cart->save) {
+        for (size_t offset = 0; offset < ramSize; offset += BATTERY_SAVE_BANK_SIZE) {
+            markBatterySaveDirty(cart->save, static_cast<uint32_t>(offset));
+        }
+    }
+}
+
+std::string generateSaveStateFilename(const std::string& romPath) {
+    return std::filesystem::path(romPath).replace_extension(".state").string();
+}
+
+size_t getSaveStateSize(const GameBoy* gb) {
+    return sizeof(SaveState) + getCartridgeRAMSize(gb->cart);
+}
+
+void captureSaveState(GameBoy* gb, uint8_t* buffer) {
+    std::fill(buffer, buffer + sizeof(SaveState), 0);
+    SaveState* state = reinterpret_cast<SaveState*>(buffer);
+
+    size_t ramSize = getCartridgeRAMSize(gb->cart);
+    std::memcpy(state->header.magic, SAVE_STATE_MAGIC, sizeof(SAVE_STATE_MAGIC));
+    state->header.version = SAVE_STATE_VERSION;
+    state->header.layoutSize = sizeof(SaveState);
+    state->header.stateSize = sizeof(SaveState) + ramSize;
+    state->header.romCRC32 = getCartridgeCRC32(gb->cart);
+    state->header.ramSize = static_cast<uint32_t>(ramSize);
+
+    captureCPU(&gb->CPU, &state->cpu);
+    capturePPU(&gb->ppu, &state->ppu);
+    captureAPU(&gb->apu, &state->apu);
+    captureBus(gb, &state->bus);
+    captureCartridge(gb->cart, &state->cart, buffer + sizeof(SaveState));
+}
+
+bool restoreSaveState(GameBoy* gb, const uint8_t* data, size_t size) {
+    if (size < sizeof(SaveState)) {
+        std::cerr << "Fichier d'tat trop court." << std::endl;
+        return false;
+    }
+
+    const SaveState* state = reinterpret_cast<const SaveState*>(data);
+    const SaveStateHeader& header = state->header;
+    if (std::memcmp(header.magic, SAVE_STATE_MAGIC, sizeof(SAVE_STATE_MAGIC)) != 0 ||
+        header.version != SAVE_STATE_VERSION || header.layoutSize != sizeof(SaveState)) {
+        std::cerr << "Format d'tat incompatible avec cette version de l'mulateur." << std::endl;
+        return false;
+    }
+
+    size_t ramSize = getCartridgeRAMSize(gb->cart);
+    if (header.ramSize != ramSize || header.stateSize != sizeof(SaveState) + ramSize || size < header.stateSize) {
+        std::cerr << "Fichier d'tat corrompu ou tronqu." << std::endl;
+        return false;
+    }
+    if (state->cart.mapper != static_cast<uint8_t>(gb->cart->Mapper) || header.romCRC32 != getCartridgeCRC32(gb->cart)) {
+        std::cerr << "Cet tat a t sauvegard avec une autre ROM." << std::endl;
+        return false;
+    }
+
+    restoreCPU(&gb->CPU, &state->cpu);
+    restoreBus(gb, &state->bus);
+    restorePPU(&gb->ppu, &state->ppu);
+    restoreAPU(&gb->apu, &state->apu);
+    restoreCartridge(gb->cart, &state->cart, data + sizeof(SaveState));
+    return true;
+}
+
+static void writeSaveStateFile(const SaveStateJob& job) {
+    std::string tempPath = job.filename + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Impossible de crer le fichier: " << tempPath << std::endl;
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(job.data.data()), job.data.size());
+        if (!file.good()) {
+            std::cerr << "Erreur lors de l'criture de l'tat: " << tempPath << std::endl;
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, job.filename, ec);
+    if (ec) {
+        std::cerr << "Erreur lors du remplacement de l'tat: " << ec.message() << std::endl;
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+static void saveStateWorkerLoop(SaveStateWriter* writer) {
+    while (true) {
+        const SaveStateJob* job;
+        {
+            std::unique_lock<std::mutex> lock(writer->mutex);
+            writer->wakeCondition.wait(lock, [&]() { return writer->stopping || !writer->queue.empty(); });
+            if (writer->queue.empty()) return;
+            job = &writer->queue.front();
+        }
+        writeSaveStateFile(*job);
+        {
+            std::lock_guard<std::mutex> lock(writer->mutex);
+            writer->queue.pop_front();
+        }
+    }
+}
+
+SaveStateWriter::~SaveStateWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_one();
+    if (workerThread.joinable()) workerThread.join();
+}
+
+void initSaveStateWriter(SaveStateWriter* writer) {
+    writer->workerThread = std::thread(saveStateWorkerLoop, writer);
+}
+
+bool queueSaveState(SaveStateWriter* writer, GameBoy* gb, const std::string& fileName) {
+    SaveStateJob job;
+    job.data.resize(getSaveStateSize(gb));
+    captureSaveState(gb, job.data.data());
+    job.filename = fileName;
+
+    {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        if (writer->queue.size() >= SAVE_STATE_QUEUE_CAPACITY) {
+            std::cerr << "Trop de sauvegardes d'tat en attente, sauvegarde ignore." << std::endl;
+            return false;
+        }
+        writer->queue.push_back(std::move(job));
+    }
+    writer->wakeCondition.notify_one();
+    return true;
+}
+
+bool loadSaveState(SaveStateWriter* writer, GameBoy* gb, const std::string& fileName) {
+    {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        for (auto it = writer->queue.rbegin(); it != writer->queue.rend(); ++it) {
+            if (it->filename == fileName) {
+                return restoreSaveState(gb, it->data.data(), it->data.size());
+            }
+        }
+    }
+
+    size_t size = 0;
+    const uint8_t* data = mapROMFile(fileName.c_str(), &size);
+    if (!data) {
+        std::cerr << "Aucun tat sauvegard: " << fileName << std::endl;
+        return false;
+    }
+
+    bool restored = restoreSaveState(gb, data, size);
+    unmapROMFile(data, size);
+    return restored;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "GB.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+constexpr char SAVE_STATE_MAGIC[8] = { 'G', 'B', 'S', 'T', 'A', 'T', 'E', 0x1A };
+constexpr uint32_t SAVE_STATE_VERSION = 1;
+constexpr size_t SAVE_STATE_QUEUE_CAPACITY = 4;
+constexpr size_t SAVE_STATE_MAPPER_SIZE = std::max({ sizeof(Cartridge::MBC1), sizeof(Cartridge::MBC5), sizeof(Cartridge::MBC3) });
+
+struct SaveStateHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t layoutSize;
+    uint64_t stateSize;
+    uint32_t romCRC32;
+    uint32_t ramSize;
+};
+
+struct SaveStateCPU {
+    uint16_t AF;
+    uint16_t BC;
+    uint16_t DE;
+    uint16_t HL;
+    uint16_t SP;
+    uint16_t PC;
+    int32_t currentCycles;
+    bool IME;
+    bool ei;
+    bool isHalted;
+    bool isStopped;
+};
+
+struct SaveStatePPU {
+    int32_t currentCycle;
+    int32_t currentScanline;
+    int32_t currentPixelX;
+    int32_t windowScanline;
+    int32_t scanlineWindowStart;
+    bool isFrameComplete;
+    bool isRenderingWindow;
+
+    uint8_t bgTileByte0;
+    uint8_t bgTileByte1;
+    uint8_t bgTileX;
+    uint8_t bgTileY;
+    uint8_t bgFineX;
+    uint8_t bgFineY;
+
+    uint8_t spriteTileByte0;
+    uint8_t spriteTileByte1;
+    uint8_t spritePalette;
+    uint8_t spriteBGPriority;
+    uint8_t activeSprites[MAX_SPRITES_PER_SCANLINE];
+    uint8_t activeSpriteCount;
+};
+
+struct SaveStateAPU {
+    uint64_t elapsedCycles;
+    uint16_t apuDivider;
+    Channel1 CH1;
+    Channel2 CH2;
+    Channel3 CH3;
+    Channel4 CH4;
+};
+
+struct SaveStateBus {
+    uint8_t vram[1][VRAM_BANK_SIZE];
+    uint8_t wram[2][WRAM_BANK_SIZE];
+    uint8_t oam[OAM_SIZE];
+    uint8_t io[IO_SIZE];
+    uint8_t hram[HRAM_SIZE];
+    uint8_t IE;
+    uint16_t div;
+    bool prev_timer_inc;
+    bool timer_overflow;
+    bool prev_stat_int;
+    bool dma_active;
+    uint8_t dma_index;
+    int32_t dma_currentCycles;
+};
+
+struct SaveStateCartridge {
+    uint8_t mapper;
+    uint8_t mapperState[SAVE_STATE_MAPPER_SIZE];
+    uint64_t clockCycles;
+};
+
+struct SaveState {
+    SaveStateHeader header;
+    SaveStateCPU cpu;
+    SaveStatePPU ppu;
+    SaveStateAPU apu;
+    SaveStateBus bus;
+    SaveStateCartridge cart;
+};
+
+static_assert(std::is_trivially_copyable_v<SaveState>);
+
+struct SaveStateJob {
+    std::vector<uint8_t> data;
+    std::string filename;
+};
+
+struct SaveStateWriter {
+    std::thread workerThread;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::deque<SaveStateJob> queue;
+    bool stopping = false;
+
+    ~SaveStateWriter();
+};
+
+std::string generateSaveStateFilename(const std::string& romPath);
+
+size_t getSaveStateSize(const GameBoy* gb);
+void captureSaveState(GameBoy* gb, uint8_t* buffer);
+bool restoreSaveState(GameBoy* gb, const uint8_t* data, size_t size);
+
+void initSaveStateWriter(SaveStateWriter* writer);
+bool queueSaveState(SaveStateWriter* writer, GameBoy* gb, const std::string& fileName);
+bool loadSaveState(SaveStateWriter* writer, GameBoy* gb, const std::string& fileName);
@@ -0,0 +1,373 @@
+#include "Screenshot.hpp"
+
+#include "PPU.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+constexpr int DEFLATE_WINDOW_SIZE = 32768;
+constexpr int DEFLATE_HASH_BITS = 15;
+constexpr int DEFLATE_MAX_CHAIN = 64;
+constexpr int DEFLATE_MIN_MATCH = 3;
+constexpr int DEFLATE_MAX_MATCH = 258;
+
+const uint16_t DEFLATE_LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t DEFLATE_LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const uint16_t DEFLATE_DISTANCE_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+const uint8_t DEFLATE_DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+struct BitWriter {
+    std::vector<uint8_t>& out;
+    uint32_t bitBuffer = 0;
+    int bitCount = 0;
+};
+
+static void writeBits(BitWriter& writer, uint32_t value, int count) {
+    writer.bitBuffer |= value << writer.bitCount;
+    writer.bitCount += count;
+    while (writer.bitCount >= 8) {
+        writer.out.push_back(static_cast<uint8_t>(writer.bitBuffer));
+        writer.bitBuffer >>= 8;
+        writer.bitCount -= 8;
+    }
+}
+
+static void flushBits(BitWriter& writer) {
+    if (writer.bitCount > 0) {
+        writer.out.push_back(static_cast<uint8_t>(writer.bitBuffer));
+    }
+    writer.bitBuffer = 0;
+    writer.bitCount = 0;
+}
+
+static uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    return reversed;
+}
+
+static void writeFixedSymbol(BitWriter& writer, int symbol) {
+    if (symbol <= 143) writeBits(writer, reverseBits(0x30 + symbol, 8), 8);
+    else if (symbol <= 255) writeBits(writer, reverseBits(0x190 + symbol - 144, 9), 9);
+    else if (symbol <= 279) writeBits(writer, reverseBits(symbol - 256, 7), 7);
+    else writeBits(writer, reverseBits(0xC0 + symbol - 280, 8), 8);
+}
+
+static void writeFixedMatch(BitWriter& writer, int length, int distance) {
+    int lengthCode = 0;
+    while (lengthCode < 28 && DEFLATE_LENGTH_BASE[lengthCode + 1] <= length) lengthCode++;
+    writeFixedSymbol(writer, 257 + lengthCode);
+    writeBits(writer, length - DEFLATE_LENGTH_BASE[lengthCode], DEFLATE_LENGTH_EXTRA[lengthCode]);
+
+    int distanceCode = 0;
+    while (distanceCode < 29 && DEFLATE_DISTANCE_BASE[distanceCode + 1] <= distance) distanceCode++;
+    writeBits(writer, reverseBits(distanceCode, 5), 5);
+    writeBits(writer, distance - DEFLATE_DISTANCE_BASE[distanceCode], DEFLATE_DISTANCE_EXTRA[distanceCode]);
+}
+
+static uint32_t hashTriplet(const uint8_t* data) {
+    uint32_t value = (data[0] << 16) | (data[1] << 8) | data[2];
+    return (value * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+}
+
+static void deflateFixed(const std::vector<uint8_t>& data, std::vector<uint8_t>& out) {
+    BitWriter writer{ out };
+    writeBits(writer, 1, 1);
+    writeBits(writer, 1, 2);
+
+    int size = static_cast<int>(data.size());
+    std::vector<int32_t> head(1 << DEFLATE_HASH_BITS, -1);
+    std::vector<int32_t> prev(size, -1);
+    auto insert = [&](int position) {
+        if (position + DEFLATE_MIN_MATCH > size) return;
+        uint32_t hash = hashTriplet(&data[position]);
+        prev[position] = head[hash];
+        head[hash] = position;
+        };
+
+    int position = 0;
+    while (position < size) {
+        int bestLength = 0;
+        int bestDistance = 0;
+        if (position + DEFLATE_MIN_MATCH <= size) {
+            int maxLength = std::min(DEFLATE_MAX_MATCH, size - position);
+            int candidate = head[hashTriplet(&data[position])];
+            for (int chain = 0; candidate >= 0 && position - candidate <= DEFLATE_WINDOW_SIZE && chain < DEFLATE_MAX_CHAIN; chain++) {
+                int length = 0;
+                while (length < maxLength && data[candidate + length] == data[position + length]) length++;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = position - candidate;
+                    if (length == maxLength) break;
+                }
+                candidate = prev[candidate];
+            }
+        }
+
+        if (bestLength >= DEFLATE_MIN_MATCH) {
+            writeFixedMatch(writer, bestLength, bestDistance);
+            for (int i = 0; i < bestLength; i++) insert(position + i);
+            position += bestLength;
+        }
+        else {
+            writeFixedSymbol(writer, data[position]);
+            insert(position);
+            position++;
+        }
+    }
+
+    writeFixedSymbol(writer, 256);
+    flushBits(writer);
+}
+
+static uint32_t adler32(const std::vector<uint8_t>& data) {
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static const std::array<uint32_t, 256>& crcTable() {
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> values{};
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            values[n] = c;
+        }
+        return values;
+        }();
+    return table;
+}
+
+static void appendBE32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void appendChunk(std::vector<uint8_t>& png, const char* type, const std::vector<uint8_t>& data) {
+    appendBE32(png, static_cast<uint32_t>(data.size()));
+    size_t crcStart = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+
+    const std::array<uint32_t, 256>& table = crcTable();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = crcStart; i < png.size(); i++) {
+        crc = table[(crc ^ png[i]) & 0xFF] ^ (crc >> 8);
+    }
+    appendBE32(png, crc ^ 0xFFFFFFFFu);
+}
+
+static bool buildPalette(const uint32_t* pixels, int count, std::vector<uint32_t>& palette, std::vector<uint8_t>& indices) {
+    indices.resize(count);
+    uint32_t lastColor = 0;
+    uint8_t lastIndex = 0;
+    bool hasLast = false;
+    for (int i = 0; i < count; i++) {
+        uint32_t color = pixels[i] & 0xFFFFFF;
+        if (!hasLast || color != lastColor) {
+            auto found = std::find(palette.begin(), palette.end(), color);
+            if (found == palette.end()) {
+                if (palette.size() == 256) return false;
+                palette.push_back(color);
+                found = palette.end() - 1;
+            }
+            lastColor = color;
+            lastIndex = static_cast<uint8_t>(found - palette.begin());
+            hasLast = true;
+        }
+        indices[i] = lastIndex;
+    }
+    return true;
+}
+
+void encodePNG(const uint32_t* pixels, int width, int height, std::vector<uint8_t>& png) {
+    std::vector<uint32_t> palette;
+    std::vector<uint8_t> indices;
+    bool indexed = buildPalette(pixels, width * height, palette, indices);
+
+    uint8_t bitDepth = 8;
+    if (indexed) {
+        bitDepth = palette.size() <= 2 ? 1 : palette.size() <= 4 ? 2 : palette.size() <= 16 ? 4 : 8;
+    }
+
+    std::vector<uint8_t> raw;
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        if (indexed) {
+            int pixelsPerByte = 8 / bitDepth;
+            for (int x = 0; x < width; x += pixelsPerByte) {
+                uint8_t packed = 0;
+                for (int i = 0; i < pixelsPerByte; i++) {
+                    uint8_t index = (x + i < width) ? indices[y * width + x + i] : 0;
+                    packed |= index << (8 - bitDepth * (i + 1));
+                }
+                raw.push_back(packed);
+            }
+        }
+        else {
+            for (int x = 0; x < width; x++) {
+                uint32_t color = pixels[y * width + x];
+                raw.push_back(static_cast<uint8_t>(color >> 16));
+                raw.push_back(static_cast<uint8_t>(color >> 8));
+                raw.push_back(static_cast<uint8_t>(color));
+            }
+        }
+    }
+
+    std::vector<uint8_t> header;
+    appendBE32(header, width);
+    appendBE32(header, height);
+    header.push_back(bitDepth);
+    header.push_back(indexed ? 3 : 2);
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+
+    std::vector<uint8_t> compressed = { 0x78, 0x01 };
+    deflateFixed(raw, compressed);
+    appendBE32(compressed, adler32(raw));
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    png.assign(signature, signature + 8);
+    appendChunk(png, "IHDR", header);
+    if (indexed) {
+        std::vector<uint8_t> plte;
+        for (uint32_t color : palette) {
+            plte.push_back(static_cast<uint8_t>(color >> 16));
+            plte.push_back(static_cast<uint8_t>(color >> 8));
+            plte.push_back(static_cast<uint8_t>(color));
+        }
+        appendChunk(png, "PLTE", plte);
+    }
+    appendChunk(png, "IDAT", compressed);
+    appendChunk(png, "IEND", {});
+}
+
+static void writeScreenshot(const ScreenshotWriter* writer, const ScreenshotJob& job) {
+    int width = SCREEN_WIDTH * writer->scale;
+    int height = SCREEN_HEIGHT * writer->scale;
+    std::vector<uint32_t> scaled(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; y++) {
+        const uint32_t* source = &job.pixels[(y / writer->scale) * SCREEN_WIDTH];
+        for (int x = 0; x < width; x++) {
+            scaled[y * width + x] = source[x / writer->scale];
+        }
+    }
+
+    std::vector<uint8_t> png;
+    encodePNG(scaled.data(), width, height, png);
+
+    std::ofstream file(job.filename, std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(png.data()), png.size())) {
+        std::cerr << "Erreur lors de la sauvegarde de l'image: " << job.filename << std::endl;
+        return;
+    }
+    std::cout << "Capture d'cran effectue -> " << job.filename << std::endl;
+}
+
+static void screenshotWorkerLoop(ScreenshotWriter* writer) {
+    while (true) {
+        ScreenshotJob job;
+        {
+            std::unique_lock<std::mutex> lock(writer->mutex);
+            writer->wakeCondition.wait(lock, [&]() { return writer->stopping || !writer->queue.empty(); });
+            if (writer->queue.empty()) return;
+            job = std::move(writer->queue.front());
+            writer->queue.pop_front();
+        }
+        writeScreenshot(writer, job);
+    }
+}
+
+static void enqueueScreenshot(ScreenshotWriter* writer, const uint32_t* frame, std::string filename) {
+    ScreenshotJob job;
+    job.pixels.assign(frame, frame + SCREEN_WIDTH * SCREEN_HEIGHT);
+    job.filename = std::move(filename);
+    {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        if (writer->queue.size() >= SCREENSHOT_QUEUE_CAPACITY) {
+            writer->droppedShots.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        writer->queue.push_back(std::move(job));
+    }
+    writer->wakeCondition.notify_one();
+}
+
+ScreenshotWriter::~ScreenshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_one();
+    if (workerThread.joinable()) workerThread.join();
+
+    uint32_t dropped = droppedShots.load(std::memory_order_relaxed);
+    if (dropped) {
+        std::cerr << "Captures d'cran : " << dropped << " images perdues (disque trop lent)" << std::endl;
+    }
+}
+
+void initScreenshotWriter(ScreenshotWriter* writer, int scale) {
+    writer->scale = std::max(scale, 1);
+    writer->workerThread = std::thread(screenshotWorkerLoop, writer);
+}
+
+std::string generateScreenshotBasename() {
+    std::time_t t = std::time(nullptr);
+    std::tm tm;
+    localtime_s(&tm, &t);
+    char buffer[100];
+    std::strftime(buffer, sizeof(buffer), "ScreenShot_%d-%m-%Y_%H-%M-%S", &tm);
+    return std::string(buffer);
+}
+
+void setScreenshotButton(ScreenshotWriter* writer, bool pressed) {
+    if (pressed) {
+        writer->captureRequested.store(true, std::memory_order_relaxed);
+    }
+    writer->burstHeld.store(pressed, std::memory_order_relaxed);
+}
+
+void captureScreenshotFrame(ScreenshotWriter* writer, const uint32_t* frame) {
+    if (writer->captureRequested.exchange(false, std::memory_order_relaxed)) {
+        writer->heldFrames = 0;
+        writer->burstIndex = 0;
+        writer->burstBasename = generateScreenshotBasename();
+        enqueueScreenshot(writer, frame, writer->burstBasename + ".png");
+        return;
+    }
+
+    if (!writer->burstHeld.load(std::memory_order_relaxed)) return;
+    if (++writer->heldFrames < SCREENSHOT_BURST_DELAY_FRAMES) return;
+
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%03d.png", ++writer->burstIndex);
+    enqueueScreenshot(writer, frame, writer->burstBasename + suffix);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr size_t SCREENSHOT_QUEUE_CAPACITY = 120;
+constexpr int SCREENSHOT_BURST_DELAY_FRAMES = 30;
+
+struct ScreenshotJob {
+    std::vector<uint32_t> pixels;
+    std::string filename;
+};
+
+struct ScreenshotWriter {
+    int scale = 1;
+
+    std::thread workerThread;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::deque<ScreenshotJob> queue;
+    bool stopping = false;
+
+    std::atomic<bool> captureRequested = false;
+    std::atomic<bool> burstHeld = false;
+    int heldFrames = 0;
+    int burstIndex = 0;
+    std::string burstBasename;
+
+    std::atomic<uint32_t> droppedShots = 0;
+
+    ~ScreenshotWriter();
+};
+
+void initScreenshotWriter(ScreenshotWriter* writer, int scale);
+std::string generateScreenshotBasename();
+
+void setScreenshotButton(ScreenshotWriter* writer, bool pressed);
+void captureScreenshotFrame(ScreenshotWriter* writer, const uint32_t* frame);
+
+void encodePNG(const uint32_t* pixels, int width, int height, std::vector<uint8_t>& png);
@@ -0,0 +1,162 @@
+#include "TimeStretch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TIME_STRETCH_SSE2 1
+#endif
+
+constexpr double TIME_STRETCH_PI = 3.14159265358979323846;
+
+static float dotProduct(const float* a, const float* b, int count) {
+#ifdef TIME_STRETCH_SSE2
+    __m128 sum = _mm_setzero_ps();
+    for (int i = 0; i < count; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#else
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+#endif
+}
+
+static int findBestFrame(const TimeStretch* stretch, int nominal) {
+    int first = std::max(0, nominal - stretch->searchFrames);
+    int last = nominal + stretch->searchFrames;
+    if (stretch->previousFrame < 0) return first;
+
+    int length = stretch->hopFrames;
+    const float* target = &stretch->mono[stretch->previousFrame + length];
+    const float* mono = stretch->mono.data();
+
+    float energy = 0.0f;
+    for (int i = 0; i < length; i++) {
+        energy += mono[first + i] * mono[first + i];
+    }
+
+    int best = first;
+    float bestScore = -INFINITY;
+    for (int candidate = first; candidate <= last; candidate++) {
+        float score = dotProduct(target, mono + candidate, length) / std::sqrt(std::max(energy, 1e-9f));
+        if (score > bestScore) {
+            bestScore = score;
+            best = candidate;
+        }
+        energy += mono[candidate + length] * mono[candidate + length] - mono[candidate] * mono[candidate];
+    }
+    return best;
+}
+
+static void addFrame(TimeStretch* stretch, int frame) {
+    const float* in = &stretch->input[frame * 2];
+    for (int i = 0; i < stretch->windowFrames; i++) {
+        stretch->overlap[i * 2] += stretch->window[i] * in[i * 2];
+        stretch->overlap[i * 2 + 1] += stretch->window[i] * in[i * 2 + 1];
+    }
+
+    int hop = stretch->hopFrames * 2;
+    stretch->output.insert(stretch->output.end(), stretch->overlap.begin(), stretch->overlap.begin() + hop);
+    std::copy(stretch->overlap.begin() + hop, stretch->overlap.end(), stretch->overlap.begin());
+    std::fill(stretch->overlap.end() - hop, stretch->overlap.end(), 0.0f);
+}
+
+static void resetTimeStretch(TimeStretch* stretch) {
+    stretch->input.clear();
+    stretch->mono.clear();
+    stretch->overlap.assign(stretch->windowFrames * 2, 0.0f);
+    stretch->inputPosition = 0.0;
+    stretch->previousFrame = -1;
+}
+
+static void drainTimeStretch(TimeStretch* stretch) {
+    int next = 0;
+    stretch->output.clear();
+    if (stretch->previousFrame >= 0) {
+        next = stretch->previousFrame + stretch->hopFrames;
+        stretch->output.assign(stretch->overlap.begin(), stretch->overlap.begin() + stretch->hopFrames * 2);
+        const float* in = &stretch->input[next * 2];
+        for (int i = 0; i < stretch->hopFrames; i++) {
+            stretch->output[i * 2] += stretch->window[i] * in[i * 2];
+            stretch->output[i * 2 + 1] += stretch->window[i] * in[i * 2 + 1];
+        }
+        next += stretch->hopFrames;
+    }
+    stretch->output.insert(stretch->output.end(), stretch->input.begin() + next * 2, stretch->input.end());
+}
+
+void initTimeStretch(TimeStretch* stretch, int sampleRate) {
+    stretch->hopFrames = std::max(4, sampleRate * TIME_STRETCH_WINDOW_MS / 2000 / 4 * 4);
+    stretch->windowFrames = stretch->hopFrames * 2;
+    stretch->searchFrames = sampleRate * TIME_STRETCH_SEARCH_MS / 1000;
+
+    stretch->window.resize(stretch->windowFrames);
+    for (int i = 0; i < stretch->windowFrames; i++) {
+        stretch->window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * TIME_STRETCH_PI * i / stretch->windowFrames));
+    }
+
+    resetTimeStretch(stretch);
+    stretch->active = false;
+}
+
+void setTimeStretchSpeed(TimeStretch* stretch, double speed) {
+    stretch->speed.store(speed, std::memory_order_relaxed);
+}
+
+const float* stretchAudioFrames(TimeStretch* stretch, const float* samples, uint32_t frames, uint32_t* outputFrames) {
+    double speed = stretch->speed.load(std::memory_order_relaxed);
+
+    if (speed == 1.0) {
+        if (!stretch->active) {
+            *outputFrames = frames;
+            return samples;
+        }
+        stretch->active = false;
+        drainTimeStretch(stretch);
+        stretch->output.insert(stretch->output.end(), samples, samples + frames * 2);
+        *outputFrames = static_cast<uint32_t>(stretch->output.size() / 2);
+        return stretch->output.data();
+    }
+
+    if (!stretch->active) {
+        resetTimeStretch(stretch);
+        stretch->active = true;
+    }
+
+    stretch->input.insert(stretch->input.end(), samples, samples + frames * 2);
+    for (uint32_t i = 0; i < frames; i++) {
+        stretch->mono.push_back(samples[i * 2] + samples[i * 2 + 1]);
+    }
+
+    stretch->output.clear();
+    int available = static_cast<int>(stretch->mono.size());
+    while (true) {
+        int nominal = static_cast<int>(std::lround(stretch->inputPosition));
+        if (nominal + stretch->searchFrames + stretch->windowFrames > available) break;
+
+        int frame = findBestFrame(stretch, nominal);
+        addFrame(stretch, frame);
+        stretch->previousFrame = frame;
+        stretch->inputPosition += speed * stretch->hopFrames;
+    }
+
+    int consumed = std::max(0, std::min(stretch->previousFrame,
+        static_cast<int>(stretch->inputPosition) - stretch->searchFrames));
+    consumed = std::min(consumed, available);
+    if (consumed > 0) {
+        stretch->input.erase(stretch->input.begin(), stretch->input.begin() + consumed * 2);
+        stretch->mono.erase(stretch->mono.begin(), stretch->mono.begin() + consumed);
+        stretch->previousFrame -= consumed;
+        stretch->inputPosition -= consumed;
+    }
+
+    *outputFrames = static_cast<uint32_t>(stretch->output.size() / 2);
+    return stretch->output.data();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+constexpr int TIME_STRETCH_WINDOW_MS = 8;
+constexpr int TIME_STRETCH_SEARCH_MS = 2;
+constexpr double TIME_STRETCH_FAST_MIN = 2.0;
+constexpr double TIME_STRETCH_FAST_MAX = 8.0;
+constexpr double TIME_STRETCH_SLOW_MIN = 0.25;
+constexpr double TIME_STRETCH_SLOW_MAX = 0.5;
+
+struct TimeStretch {
+    int windowFrames = 0;
+    int hopFrames = 0;
+    int searchFrames = 0;
+    std::vector<float> window;
+
+    std::vector<float> input;
+    std::vector<float> mono;
+    std::vector<float> overlap;
+    std::vector<float> output;
+    double inputPosition = 0.0;
+    int previousFrame = -1;
+    bool active = false;
+
+    std::atomic<double> speed = 1.0;
+};
+
+void initTimeStretch(TimeStretch* stretch, int sampleRate);
+void setTimeStretchSpeed(TimeStretch* stretch, double speed);
+const float* stretchAudioFrames(TimeStretch* stretch, const float* samples, uint32_t frames, uint32_t* outputFrames);
@@ -0,0 +1,94 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+
+static void runPendingTasks(WorkerPool* pool) {
+    for (int i = pool->nextTask.fetch_add(1, std::memory_order_relaxed);
+        i < pool->taskCount;
+        i = pool->nextTask.fetch_add(1, std::memory_order_relaxed)) {
+        pool->task(i);
+    }
+}
+
+static void workerLoop(WorkerPool* pool) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->wakeCondition.wait(lock, [&]() {
+                return pool->stopping || pool->generation != seenGeneration;
+                });
+            if (pool->stopping) return;
+            seenGeneration = pool->generation;
+        }
+
+        runPendingTasks(pool);
+
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (--pool->busyWorkers == 0) {
+            pool->doneCondition.notify_one();
+        }
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stopWorkerPool(this);
+}
+
+int defaultWorkerCount(int reservedThreads) {
+    int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(hardwareThreads - reservedThreads, 0, 7);
+}
+
+void startWorkerPool(WorkerPool* pool, int threadCount) {
+    stopWorkerPool(pool);
+    pool->stopping = false;
+    for (int i = 0; i < threadCount; i++) {
+        pool->workers.emplace_back(workerLoop, pool);
+    }
+}
+
+void stopWorkerPool(WorkerPool* pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->stopping = true;
+    }
+    pool->wakeCondition.notify_all();
+    for (auto& worker : pool->workers) {
+        if (worker.joinable()) worker.join();
+    }
+    pool->workers.clear();
+}
+
+void parallelFor(WorkerPool* pool, int count, const std::function<void(int)>& task) {
+    if (pool->workers.empty() || count <= 1) {
+        for (int i = 0; i < count; i++) task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->task = task;
+        pool->taskCount = count;
+        pool->nextTask.store(0, std::memory_order_relaxed);
+        pool->busyWorkers = static_cast<int>(pool->workers.size());
+        pool->generation++;
+    }
+    pool->wakeCondition.notify_all();
+
+    runPendingTasks(pool);
+
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    pool->doneCondition.wait(lock, [&]() { return pool->busyWorkers == 0; });
+    pool->task = nullptr;
+}
+
+void parallelForRows(WorkerPool* pool, int rows, const std::function<void(int, int)>& task) {
+    int chunks = std::min(rows, static_cast<int>(pool->workers.size() + 1) * 4);
+    if (chunks <= 0) return;
+    parallelFor(pool, chunks, [&](int chunk) {
+        int begin = rows * chunk / chunks;
+        int end = rows * (chunk + 1) / chunks;
+        task(begin, end);
+        });
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct WorkerPool {
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    std::function<void(int)> task;
+    int taskCount = 0;
+    std::atomic<int> nextTask = 0;
+    int busyWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    ~WorkerPool();
+};
+
+int defaultWorkerCount(int reservedThreads);
+
+void startWorkerPool(WorkerPool* pool, int threadCount);
+void stopWorkerPool(WorkerPool* pool);
+
+void parallelFor(WorkerPool* pool, int count, const std::function<void(int)>& task);
+void parallelForRows(WorkerPool* pool, int rows, const std::function<void(int, int)>& task);
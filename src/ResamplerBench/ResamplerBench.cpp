@@ -0,0 +1,167 @@
+#include "../GameBoy/Resampler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+constexpr double BENCH_INPUT_RATE = 65536.0;
+constexpr int BENCH_BLOCK_FRAMES = 128;
+constexpr int BENCH_WARMUP_FRAMES = 1024;
+constexpr int BENCH_MEASURE_FRAMES = 16384;
+constexpr int BENCH_TIMING_FRAMES = 1 << 22;
+constexpr double BENCH_PASSBAND_EDGE = 0.33;
+constexpr double BENCH_STOPBAND_EDGE = 0.5;
+constexpr double BENCH_TONE_AMPLITUDE = 0.89125;
+constexpr double BENCH_THD_FREQUENCY = 1000.0;
+constexpr double BENCH_PI = 3.14159265358979323846;
+
+static volatile float benchSink;
+
+struct ToneFit {
+    double amplitude;
+    double residual;
+};
+
+static std::vector<float> resampleTone(bool vectorized, double outputRate, double frequency, int outputFrames) {
+    auto resampler = std::make_unique<Resampler>();
+    initResampler(resampler.get(), BENCH_INPUT_RATE, outputRate);
+    resampler->vectorized = vectorized;
+
+    std::vector<float> output(static_cast<size_t>(outputFrames) * 2);
+    std::vector<float> block(BENCH_BLOCK_FRAMES * 2);
+    int64_t inputFrame = 0;
+    for (int frame = 0; frame < outputFrames; frame += BENCH_BLOCK_FRAMES) {
+        int needed = resamplerInputNeeded(resampler.get(), BENCH_BLOCK_FRAMES);
+        for (int i = 0; i < needed; i++, inputFrame++) {
+            float value = static_cast<float>(BENCH_TONE_AMPLITUDE * std::sin(2.0 * BENCH_PI * frequency * inputFrame / BENCH_INPUT_RATE));
+            resampler->left[resampler->buffered + i] = value;
+            resampler->right[resampler->buffered + i] = value;
+        }
+        resampleFrames(resampler.get(), needed, block.data(), BENCH_BLOCK_FRAMES);
+        std::copy(block.begin(), block.end(), output.begin() + static_cast<size_t>(frame) * 2);
+    }
+    return output;
+}
+
+static ToneFit fitTone(const std::vector<float>& output, double outputRate, double frequency) {
+    double ss = 0.0, sc = 0.0, cc = 0.0, sy = 0.0, cy = 0.0;
+    for (int frame = BENCH_WARMUP_FRAMES; frame < BENCH_WARMUP_FRAMES + BENCH_MEASURE_FRAMES; frame++) {
+        double angle = 2.0 * BENCH_PI * frequency * frame / outputRate;
+        double s = std::sin(angle);
+        double c = std::cos(angle);
+        double y = output[static_cast<size_t>(frame) * 2];
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        sy += s * y;
+        cy += c * y;
+    }
+    double determinant = ss * cc - sc * sc;
+    double a = (sy * cc - cy * sc) / determinant;
+    double b = (cy * ss - sy * sc) / determinant;
+
+    double residual = 0.0;
+    for (int frame = BENCH_WARMUP_FRAMES; frame < BENCH_WARMUP_FRAMES + BENCH_MEASURE_FRAMES; frame++) {
+        double angle = 2.0 * BENCH_PI * frequency * frame / outputRate;
+        double error = output[static_cast<size_t>(frame) * 2] - (a * std::sin(angle) + b * std::cos(angle));
+        residual += error * error;
+    }
+    return { std::sqrt(a * a + b * b), std::sqrt(residual / BENCH_MEASURE_FRAMES) };
+}
+
+static double toDecibels(double ratio) {
+    return 20.0 * std::log10(std::max(ratio, 1e-12));
+}
+
+static double measurePassbandRipple(bool vectorized, double outputRate) {
+    double minimum = 1e9;
+    double maximum = -1e9;
+    double bandwidth = std::min(outputRate, BENCH_INPUT_RATE);
+    for (double frequency = 20.0; frequency <= bandwidth * BENCH_PASSBAND_EDGE; frequency *= 1.05) {
+        int frames = BENCH_WARMUP_FRAMES + BENCH_MEASURE_FRAMES;
+        ToneFit fit = fitTone(resampleTone(vectorized, outputRate, frequency, frames), outputRate, frequency);
+        double gain = toDecibels(fit.amplitude / BENCH_TONE_AMPLITUDE);
+        minimum = std::min(minimum, gain);
+        maximum = std::max(maximum, gain);
+    }
+    return maximum - minimum;
+}
+
+static double measureStopbandRejection(bool vectorized, double outputRate) {
+    double worst = -1e9;
+    for (double frequency = outputRate * BENCH_STOPBAND_EDGE; frequency < BENCH_INPUT_RATE / 2; frequency += 250.0) {
+        int frames = BENCH_WARMUP_FRAMES + BENCH_MEASURE_FRAMES;
+        std::vector<float> output = resampleTone(vectorized, outputRate, frequency, frames);
+        double energy = 0.0;
+        for (int frame = BENCH_WARMUP_FRAMES; frame < frames; frame++) {
+            double value = output[static_cast<size_t>(frame) * 2];
+            energy += value * value;
+        }
+        double rms = std::sqrt(energy / BENCH_MEASURE_FRAMES);
+        worst = std::max(worst, toDecibels(rms / (BENCH_TONE_AMPLITUDE / std::sqrt(2.0))));
+    }
+    return -worst;
+}
+
+static double measureTHDN(bool vectorized, double outputRate) {
+    int frames = BENCH_WARMUP_FRAMES + BENCH_MEASURE_FRAMES;
+    ToneFit fit = fitTone(resampleTone(vectorized, outputRate, BENCH_THD_FREQUENCY, frames), outputRate, BENCH_THD_FREQUENCY);
+    return toDecibels(fit.residual / (fit.amplitude / std::sqrt(2.0)));
+}
+
+static double measureCost(bool vectorized, double outputRate) {
+    auto resampler = std::make_unique<Resampler>();
+    initResampler(resampler.get(), BENCH_INPUT_RATE, outputRate);
+    resampler->vectorized = vectorized;
+
+    std::vector<float> block(BENCH_BLOCK_FRAMES * 2);
+    float checksum = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < BENCH_TIMING_FRAMES; frame += BENCH_BLOCK_FRAMES) {
+        int needed = resamplerInputNeeded(resampler.get(), BENCH_BLOCK_FRAMES);
+        for (int i = 0; i < needed; i++) {
+            float value = static_cast<float>((frame + i) & 0xFF) / 256.0f - 0.5f;
+            resampler->left[resampler->buffered + i] = value;
+            resampler->right[resampler->buffered + i] = -value;
+        }
+        resampleFrames(resampler.get(), needed, block.data(), BENCH_BLOCK_FRAMES);
+        checksum += block[0];
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    benchSink = checksum;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / BENCH_TIMING_FRAMES;
+}
+
+int main() {
+    const double outputRates[] = { 22050.0, 44100.0, 48000.0, 96000.0 };
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Rchantillonneur " << RESAMPLER_TAPS << " coefficients, " << RESAMPLER_PHASE_COUNT
+        << " phases, entre " << std::setprecision(0) << BENCH_INPUT_RATE << " Hz" << std::endl;
+    std::cout << "chemin  sortie(Hz)  ondulation(dB)  rjection(dB)  THD+N 1kHz(dB)  ns/trame" << std::endl;
+
+    for (bool vectorized : { true, false }) {
+        if (vectorized && !isResamplerVectorized()) continue;
+        for (double outputRate : outputRates) {
+            bool downsampling = outputRate < BENCH_INPUT_RATE;
+            std::cout << std::setw(6) << (vectorized ? "SSE2" : "scalar")
+                << std::setw(12) << std::setprecision(0) << outputRate
+                << std::setw(16) << std::setprecision(4) << measurePassbandRipple(vectorized, outputRate)
+                << std::setw(15) << std::setprecision(1);
+            if (downsampling) {
+                std::cout << measureStopbandRejection(vectorized, outputRate);
+            }
+            else {
+                std::cout << "-";
+            }
+            std::cout << std::setw(16) << measureTHDN(vectorized, outputRate)
+                << std::setw(10) << std::setprecision(2) << measureCost(vectorized, outputRate)
+                << std::endl;
+        }
+    }
+    return 0;
+}